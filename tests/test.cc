@@ -1,6 +1,9 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/benchmark/catch_benchmark_all.hpp>
 
+#include <numeric>
+#include <sstream>
+
 #include "../varvec.hpp"
 
 using trivial_vector = varvec::static_vector<32, 8, bool, int, float>;
@@ -84,6 +87,73 @@ static_assert(
   std::movable<dynamic_movable_vector>
 );
 
+using small_copyable_vector = varvec::small_vector<64, 4, bool, int, float, std::string>;
+
+static_assert(
+  !std::is_trivially_destructible_v<small_copyable_vector>
+  &&
+  std::copyable<small_copyable_vector>
+  &&
+  std::movable<small_copyable_vector>
+);
+
+using small_movable_vector = varvec::small_vector<64, 4, bool, int, float, std::string, std::unique_ptr<double>>;
+
+static_assert(
+  !std::is_trivially_destructible_v<small_movable_vector>
+  &&
+  !std::copyable<small_movable_vector>
+  &&
+  std::movable<small_movable_vector>
+);
+
+using block_copyable_vector = varvec::block_vector<bool, int, float, std::string>;
+
+static_assert(
+  !std::is_trivially_destructible_v<block_copyable_vector>
+  &&
+  std::copyable<block_copyable_vector>
+  &&
+  std::movable<block_copyable_vector>
+);
+
+using block_movable_vector = varvec::block_vector<bool, int, float, std::string, std::unique_ptr<double>>;
+
+static_assert(
+  !std::is_trivially_destructible_v<block_movable_vector>
+  &&
+  !std::copyable<block_movable_vector>
+  &&
+  std::movable<block_movable_vector>
+);
+
+template <size_t tag>
+struct tagged {
+  bool operator ==(tagged const&) const = default;
+  int64_t value;
+};
+
+template <template <class...> class Container, size_t... tags>
+Container<tagged<tags>...> tagged_list(std::index_sequence<tags...>);
+
+// Container parameterized with count distinct tagged types.
+template <template <class...> class Container, size_t count>
+using tagged_list_t = decltype(tagged_list<Container>(std::make_index_sequence<count> {}));
+
+// Dispatch for this type list checks tagged<2>, then tagged<1>, first, and counts dispatches.
+using skewed_variant = std::variant<bool, tagged<1>, std::string, tagged<2>>;
+
+template <>
+struct varvec::storage::dispatch_hint<skewed_variant> :
+  varvec::storage::dispatch_policy<true, tagged<2>, tagged<1>>
+{};
+
+// Used to benchmark a vector that is mostly int64_t.
+template <>
+struct varvec::storage::dispatch_hint<std::variant<bool, short, int, float, double, int64_t>> :
+  varvec::storage::dispatch_policy<false, int64_t>
+{};
+
 TEST_CASE("construction properties", "[varvec tests]") {
   auto asserts = [] <class V> (varvec::meta::identity<V>) {
     V vec;
@@ -112,6 +182,10 @@ TEST_CASE("construction properties", "[varvec tests]") {
   asserts(varvec::meta::identity<movable_vector> {});
   asserts(varvec::meta::identity<dynamic_copyable_vector> {});
   asserts(varvec::meta::identity<dynamic_movable_vector> {});
+  asserts(varvec::meta::identity<small_copyable_vector> {});
+  asserts(varvec::meta::identity<small_movable_vector> {});
+  asserts(varvec::meta::identity<block_copyable_vector> {});
+  asserts(varvec::meta::identity<block_movable_vector> {});
 }
 
 TEST_CASE("container properties", "[varvec tests]") {
@@ -197,6 +271,10 @@ TEST_CASE("container properties", "[varvec tests]") {
   asserts(varvec::meta::identity<movable_vector> {});
   asserts(varvec::meta::identity<dynamic_copyable_vector> {});
   asserts(varvec::meta::identity<dynamic_movable_vector> {});
+  asserts(varvec::meta::identity<small_copyable_vector> {});
+  asserts(varvec::meta::identity<small_movable_vector> {});
+  asserts(varvec::meta::identity<block_copyable_vector> {});
+  asserts(varvec::meta::identity<block_movable_vector> {});
 }
 
 TEST_CASE("move-only properties", "varvec tests") {
@@ -229,7 +307,7 @@ TEST_CASE("move-only properties", "varvec tests") {
       std::visit(varvec::overload {
         [] (std::unique_ptr<double> const* doubleptr) { REQUIRE(**doubleptr == 3.14159); },
         [] (auto&&) { REQUIRE(false); }
-      }, *it++);
+      }, typename std::decay_t<decltype(v)>::value_type {*it++});
 
       v.visit(3, varvec::overload {
         [] (std::unique_ptr<double>& ptr) { REQUIRE(*ptr == 3.14159); },
@@ -254,6 +332,8 @@ TEST_CASE("move-only properties", "varvec tests") {
   };
   asserts(varvec::meta::identity<movable_vector> {});
   asserts(varvec::meta::identity<dynamic_movable_vector> {});
+  asserts(varvec::meta::identity<small_movable_vector> {});
+  asserts(varvec::meta::identity<block_movable_vector> {});
 }
 
 TEST_CASE("mutation", "varvec tests") {
@@ -333,6 +413,10 @@ TEST_CASE("mutation", "varvec tests") {
   asserts(varvec::meta::identity<movable_vector> {});
   asserts(varvec::meta::identity<dynamic_copyable_vector> {});
   asserts(varvec::meta::identity<dynamic_movable_vector> {});
+  asserts(varvec::meta::identity<small_copyable_vector> {});
+  asserts(varvec::meta::identity<small_movable_vector> {});
+  asserts(varvec::meta::identity<block_copyable_vector> {});
+  asserts(varvec::meta::identity<block_movable_vector> {});
 }
 
 TEST_CASE("resize", "varvec tests") {
@@ -368,145 +452,1590 @@ TEST_CASE("resize", "varvec tests") {
   }
 }
 
-TEST_CASE("insert and erase", "varvec tests") {
-  auto asserts = [] <class V> (varvec::meta::identity<V>) {
-    using val = typename V::value_type;
+TEST_CASE("offset storage", "varvec tests") {
+  varvec::storage::offsets::dynamic_offset_storage offsets(4);
+  REQUIRE(offsets.width == sizeof(uint8_t));
+  REQUIRE(offsets.size() == 4);
+  REQUIRE(offsets.used_bytes() == 4);
 
-    V vec;
-    vec.push_back("a long enough string that the small string optimization won't apply");
-    vec.push_back("a long enough string that the small string optimization won't apply");
-    vec.insert(0, true);
-    vec.insert(1, false);
-    vec.push_back("a long enough string that the small string optimization won't apply");
-    vec.insert(3, 3.5f);
-    vec.insert(6, "a final value");
+  offsets.set(0, 0);
+  offsets.set(1, 200);
+  REQUIRE(offsets.can_handle(255));
+  REQUIRE(!offsets.can_handle(256));
 
-    REQUIRE(vec.size() == 7);
-    REQUIRE(vec[0] == val {true});
-    REQUIRE(vec[1] == val {false});
-    REQUIRE(vec[2] == val {"a long enough string that the small string optimization won't apply"});
-    REQUIRE(vec[3] == val {3.5f});
-    REQUIRE(vec[4] == val {"a long enough string that the small string optimization won't apply"});
-    REQUIRE(vec[5] == val {"a long enough string that the small string optimization won't apply"});
-    REQUIRE(vec[6] == val {"a final value"});
+  // Widening should preserve everything we've already stored.
+  offsets.realloc_for(70000);
+  REQUIRE(offsets.width == sizeof(uint32_t));
+  offsets.set(2, 70000);
+  REQUIRE(offsets[0] == 0);
+  REQUIRE(offsets[1] == 200);
+  REQUIRE(offsets[2] == 70000);
 
-    auto it = vec.erase(0);
-    it = vec.erase(it);
-    it = vec.erase(it);
-    REQUIRE(vec.size() == 4);
-    REQUIRE(vec[0] == val {3.5f});
-    REQUIRE(vec[1] == val {"a long enough string that the small string optimization won't apply"});
-    REQUIRE(vec[2] == val {"a long enough string that the small string optimization won't apply"});
-    REQUIRE(vec[3] == val {"a final value"});
+  offsets.resize(8);
+  REQUIRE(offsets.size() == 8);
+  REQUIRE(offsets.used_bytes() == 8 * sizeof(uint32_t));
+  REQUIRE(offsets[2] == 70000);
 
-    it = vec.erase(it);
-    it = vec.erase(it);
-    it = vec.erase(it);
-    REQUIRE(vec.size() == 1);
-    REQUIRE(vec[0] == val {"a final value"});
+  auto copy = offsets;
+  size_t total = copy.with_offsets([] (auto const* offs) {
+    size_t sum = 0;
+    for (size_t i = 0; i < 3; ++i) sum += offs[i];
+    return sum;
+  });
+  REQUIRE(total == 70200);
 
-    it = vec.erase(it);
-    REQUIRE(vec.size() == 0);
-    REQUIRE(it == vec.end());
-    for (auto v : vec) REQUIRE(false);
-  };
-  asserts(varvec::meta::identity<copyable_vector> {});
-  asserts(varvec::meta::identity<movable_vector> {});
-  asserts(varvec::meta::identity<dynamic_copyable_vector> {});
-  asserts(varvec::meta::identity<dynamic_movable_vector> {});
+  // Offsets large enough to force widening should be transparent through the vector.
+  varvec::vector<int, std::array<char, 1024>> vec;
+  for (int i = 0; i < 128; ++i) {
+    vec.push_back(std::array<char, 1024> {});
+    vec.push_back(i);
+  }
+  for (int i = 0; i < 128; ++i) {
+    REQUIRE(vec.get<int>(i * 2 + 1) == i);
+  }
 }
 
-#ifdef VARVEC_BENCHMARK
-TEST_CASE("performance", "varvec benchmarks") {
-  copyable_vector vec;
-  dynamic_copyable_vector dvec;
-  std::vector<std::variant<bool, int, float, std::string>> stdvec;
+TEST_CASE("small vector", "varvec tests") {
+  using value = std::variant<bool, int, float, std::string>;
+  using trivial_small_vector = varvec::small_vector<16, 4, bool, int, float>;
 
-  vec.push_back(bool(rand() % 2));
-  vec.push_back(rand());
-  vec.push_back(0.5f + rand());
-  vec.push_back("hello world" + std::to_string(rand()));
+  trivial_small_vector trivial;
+  auto const inline_bytes = trivial.used_bytes();
+  trivial.push_back(true);
+  trivial.push_back(1);
+  trivial.push_back(2.5f);
+  REQUIRE(trivial.used_bytes() == inline_bytes);
 
-  dvec.push_back(bool(rand() % 2));
-  dvec.push_back(rand());
-  dvec.push_back(0.5f + rand());
-  dvec.push_back("hello world" + std::to_string(rand()));
+  // Overflows the member budget.
+  trivial.push_back(3);
+  trivial.push_back(4);
+  REQUIRE(trivial.size() == 5);
+  REQUIRE(trivial.capacity() > 4);
+  REQUIRE(trivial.used_bytes() > inline_bytes);
+  REQUIRE(trivial.get<bool>(0) == true);
+  REQUIRE(trivial.get<int>(1) == 1);
+  REQUIRE(trivial.get<float>(2) == 2.5f);
+  REQUIRE(trivial.get<int>(3) == 3);
+  REQUIRE(trivial.get<int>(4) == 4);
 
-  stdvec.push_back(bool(rand() % 2));
-  stdvec.push_back(rand());
-  stdvec.push_back(0.5f + rand());
-  stdvec.push_back("hello world" + std::to_string(rand()));
+  // Overflows the byte budget with a type that needs alignment.
+  using tiny_vector = varvec::small_vector<16, 2, bool, int, float, std::string>;
+  tiny_vector vec;
+  vec.push_back(true);
+  vec.push_back("a long enough string that the small string optimization won't apply");
+  vec.push_back(1337);
+  REQUIRE(vec.size() == 3);
+  REQUIRE(vec[0] == value {true});
+  REQUIRE(vec[1] == value {"a long enough string that the small string optimization won't apply"});
+  REQUIRE(vec[2] == value {1337});
 
-  BENCHMARK("static vector bool subscript operator") {
-    return vec[0];
-  };
-  BENCHMARK("static vector int subscript operator") {
-    return vec[1];
-  };
-  BENCHMARK("static vector float subscript operator") {
-    return vec[2];
-  };
-  BENCHMARK("static vector std::string subscript operator") {
-    return vec[3];
-  };
+  auto copy = vec;
+  auto moved = std::move(vec);
+  REQUIRE(copy == moved);
+  REQUIRE(vec.empty());
 
-  BENCHMARK("dynamic vector bool subscript operator") {
-    return dvec[0];
-  };
-  BENCHMARK("dynamic vector int subscript operator") {
-    return dvec[1];
-  };
-  BENCHMARK("dynamic vector float subscript operator") {
-    return dvec[2];
-  };
-  BENCHMARK("dynamic vector std::string subscript operator") {
-    return dvec[3];
-  };
+  moved.insert(0, "inserted");
+  REQUIRE(moved[0] == value {"inserted"});
+  REQUIRE(moved[2] == value {"a long enough string that the small string optimization won't apply"});
+  moved.erase(0);
+  REQUIRE(copy == moved);
 
-  BENCHMARK("std::vector<std::variant> bool subscript operator") {
-    return stdvec[0];
-  };
-  BENCHMARK("std::vector<std::variant> int subscript operator") {
-    return stdvec[1];
-  };
-  BENCHMARK("std::vector<std::variant> float subscript operator") {
-    return stdvec[2];
-  };
-  BENCHMARK("std::vector<std::variant> std::string subscript operator") {
-    return stdvec[3];
-  };
+  // Should be reusable after being moved from.
+  vec.push_back(5);
+  REQUIRE(vec.size() == 1);
+  REQUIRE(vec[0] == value {5});
 
-  BENCHMARK("static vector bool get") {
-    return vec.get<bool>(0);
-  };
-  BENCHMARK("static vector int get") {
-    return vec.get<int>(1);
-  };
-  BENCHMARK("static vector float get") {
-    return vec.get<float>(2);
-  };
-  BENCHMARK("static vector std::string get") {
-    return vec.get<std::string>(3);
-  };
+  tiny_vector reserved(16);
+  REQUIRE(reserved.capacity() == 16);
+}
 
-  BENCHMARK("dynamic vector bool get") {
-    return dvec.get<bool>(0);
-  };
-  BENCHMARK("dynamic vector int get") {
-    return dvec.get<int>(1);
+struct counting_allocator {
+  static uint8_t* allocate(size_t bytes, size_t alignment) {
+    ++allocations;
+    return varvec::storage::default_allocator::allocate(bytes, alignment);
+  }
+  static void deallocate(uint8_t* ptr, size_t bytes, size_t alignment) noexcept {
+    ++deallocations;
+    varvec::storage::default_allocator::deallocate(ptr, bytes, alignment);
+  }
+  static inline size_t allocations = 0;
+  static inline size_t deallocations = 0;
+};
+
+template <class Variant>
+using counted_block_storage = varvec::storage::basic_block_storage<Variant, counting_allocator>;
+
+TEST_CASE("block storage", "varvec tests") {
+  using value = std::variant<bool, int, float, std::string, std::array<char, 1024>>;
+  using counted_vector = varvec::basic_variable_vector<
+    counted_block_storage,
+    std::variant,
+    bool, int, float, std::string, std::array<char, 1024>
+  >;
+
+  {
+    counted_vector vec;
+    REQUIRE(counting_allocator::allocations == 1);
+
+    // Each resize should cost exactly one allocation.
+    auto allocations = counting_allocator::allocations;
+    auto capacity = vec.capacity();
+    while (vec.capacity() == capacity) vec.push_back(1);
+    REQUIRE(counting_allocator::allocations == allocations + 1);
+
+    // Large elements force the offsets to widen as the block grows.
+    vec.push_back("a long enough string that the small string optimization won't apply");
+    for (int i = 0; i < 128; ++i) vec.push_back(std::array<char, 1024> {});
+    vec.push_back(true);
+    REQUIRE(vec.size() == capacity + 131);
+    REQUIRE(vec[capacity] == value {1});
+    REQUIRE(vec[capacity + 1] == value {"a long enough string that the small string optimization won't apply"});
+    REQUIRE(vec.back() == value {true});
+
+    auto copy = vec;
+    REQUIRE(copy == vec);
+    REQUIRE(copy.used_bytes() == vec.used_bytes());
+  }
+  REQUIRE(counting_allocator::allocations == counting_allocator::deallocations);
+}
+
+TEST_CASE("memory resources", "varvec tests") {
+  struct counting_resource : std::pmr::memory_resource {
+    void* do_allocate(size_t bytes, size_t alignment) override {
+      ++allocations;
+      return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+      ++deallocations;
+      std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+      return this == &other;
+    }
+    size_t allocations = 0;
+    size_t deallocations = 0;
   };
-  BENCHMARK("dynamic vector float get") {
-    return dvec.get<float>(2);
+  using value = std::variant<bool, int, float, std::string>;
+  using pmr_vector = varvec::pmr::vector<bool, int, float, std::string>;
+
+  counting_resource resource;
+  {
+    pmr_vector vec(&resource);
+    REQUIRE(resource.allocations == 3);
+
+    for (int i = 0; i < 64; ++i) {
+      vec.push_back(i);
+      vec.push_back("a long enough string that the small string optimization won't apply");
+    }
+    REQUIRE(vec.size() == 128);
+    REQUIRE(vec[126] == value {63});
+
+    auto copy = vec;
+    REQUIRE(copy == vec);
+
+    auto moved = std::move(copy);
+    REQUIRE(moved == vec);
+  }
+  REQUIRE(resource.allocations > 3);
+  REQUIRE(resource.allocations == resource.deallocations);
+
+  // Everything should be able to live in an arena.
+  std::array<std::byte, 4096> buffer;
+  std::pmr::monotonic_buffer_resource arena {buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+  pmr_vector vec(4, &arena);
+  vec.push_back(true);
+  vec.push_back(1337);
+  vec.push_back(3.5f);
+  vec.push_back("hello world");
+  REQUIRE(vec.size() == 4);
+  REQUIRE(vec[3] == value {"hello world"});
+}
+
+TEST_CASE("serialization", "varvec tests") {
+  using value = std::variant<bool, int, float, double>;
+  using dynamic_vector = varvec::vector<bool, int, float, double>;
+  using fixed_vector = varvec::static_vector<1024, 128, bool, int, float, double>;
+
+  dynamic_vector vec;
+  for (int i = 0; i < 32; ++i) {
+    vec.push_back(i % 2 == 0);
+    vec.push_back(i);
+    vec.push_back(i + 0.5f);
+    vec.push_back(i + 0.25);
+  }
+
+  auto bytes = vec.to_bytes();
+  REQUIRE(bytes.size() == vec.serialized_size());
+
+  auto round_trip = dynamic_vector::from_bytes(bytes);
+  REQUIRE(round_trip.size() == vec.size());
+  REQUIRE(round_trip == vec);
+  REQUIRE(round_trip[97] == value {24});
+
+  // Format is shared between storage policies.
+  auto fixed = fixed_vector::from_bytes(bytes);
+  REQUIRE(fixed.size() == vec.size());
+  for (size_t i = 0; i < vec.size(); ++i) REQUIRE(fixed[i] == vec[i]);
+  auto fixed_round_trip = dynamic_vector::from_bytes(fixed.to_bytes());
+  REQUIRE(fixed_round_trip == vec);
+
+  auto empty = dynamic_vector::from_bytes(dynamic_vector {}.to_bytes());
+  REQUIRE(empty.empty());
+
+  std::array<std::byte, 16> small_buffer;
+  REQUIRE_THROWS_AS(vec.serialize(small_buffer), std::length_error);
+
+  // Validation
+  auto truncated = bytes;
+  truncated.resize(bytes.size() - 1);
+  REQUIRE_THROWS_AS(dynamic_vector::from_bytes(truncated), std::invalid_argument);
+  REQUIRE_THROWS_AS(dynamic_vector::from_bytes(std::span(bytes).first(8)), std::invalid_argument);
+  using other_vector = varvec::vector<bool, int, float>;
+  REQUIRE_THROWS_AS(other_vector::from_bytes(bytes), std::invalid_argument);
+
+  auto corrupted = bytes;
+  corrupted[0] = std::byte {0};
+  REQUIRE_THROWS_AS(dynamic_vector::from_bytes(corrupted), std::invalid_argument);
+
+  // Doesn't fit.
+  using tiny_vector = varvec::static_vector<64, 8, bool, int, float, double>;
+  REQUIRE_THROWS_AS(tiny_vector::from_bytes(bytes), std::bad_alloc);
+}
+
+TEST_CASE("views", "varvec tests") {
+  using value = std::variant<bool, int, float, double>;
+  using dynamic_vector = varvec::vector<bool, int, float, double>;
+  using view = varvec::vector_view<bool, int, float, double>;
+
+  dynamic_vector vec;
+  for (int i = 0; i < 128; ++i) {
+    vec.push_back(i % 2 == 0);
+    vec.push_back(i);
+    vec.push_back(i + 0.5f);
+    vec.push_back(i + 0.25);
+  }
+
+  // View over a serialized buffer, no copies.
+  auto bytes = vec.to_bytes();
+  view serialized {bytes};
+  REQUIRE(serialized.size() == vec.size());
+  for (size_t i = 0; i < vec.size(); ++i) REQUIRE(serialized[i] == vec[i]);
+  REQUIRE(serialized.get<int>(5) == 1);
+  REQUIRE(serialized.get<double>(7) == 1.25);
+  REQUIRE(serialized.get_at<float>(6) == 1.5f);
+  REQUIRE_THROWS_AS(serialized.get_at<float>(5), std::bad_cast);
+  REQUIRE_THROWS_AS(serialized.at(vec.size()), std::out_of_range);
+
+  double sum = 0;
+  for (size_t i = 0; i < serialized.size(); ++i) {
+    serialized.visit(i, [&] (auto const& val) { sum += val; });
+  }
+  REQUIRE(sum == std::accumulate(vec.begin(), vec.end(), 0.0, [] (double acc, auto const& val) {
+    return acc + val.visit([] (auto const& v) -> double { return v; });
+  }));
+
+  // View over a live vector.
+  auto live = vec.view();
+  REQUIRE(live == serialized);
+  REQUIRE(std::equal(live.begin(), live.end(), vec.begin()));
+  REQUIRE(view {} .empty());
+
+  // Views work for types that can't be serialized.
+  varvec::vector<int, std::string, std::unique_ptr<int>> strings;
+  strings.push_back(5);
+  strings.push_back("hello world");
+  strings.push_back(std::make_unique<int>(10));
+  auto strings_view = strings.view();
+  REQUIRE(strings_view.size() == 3);
+  REQUIRE(strings_view.get<std::string>(1) == "hello world");
+  REQUIRE(*strings_view.get<std::unique_ptr<int>>(2) == 10);
+  REQUIRE(strings_view[0] == strings[0]);
+
+  bytes[0] = std::byte {0};
+  REQUIRE_THROWS_AS(view {bytes}, std::invalid_argument);
+  REQUIRE(value {true} == serialized.front());
+}
+
+#ifdef __linux__
+TEST_CASE("mapped storage", "varvec tests") {
+  using value = std::variant<bool, int, float, double>;
+  using mapped = varvec::mapped_vector<bool, int, float, double>;
+
+  auto const path = std::filesystem::temp_directory_path() / "varvec_mapped_storage_test.bin";
+  std::filesystem::remove(path);
+
+  varvec::vector<bool, int, float, double> expected;
+  {
+    mapped vec {path};
+    REQUIRE(vec.empty());
+    for (int i = 0; i < 5000; ++i) {
+      vec.push_back(i % 2 == 0);
+      vec.push_back(i);
+      vec.push_back(i + 0.5f);
+      vec.push_back(i + 0.25);
+      expected.push_back(i % 2 == 0);
+      expected.push_back(i);
+      expected.push_back(i + 0.5f);
+      expected.push_back(i + 0.25);
+    }
+    vec.sync();
+  }
+
+  // Contents persist.
+  {
+    mapped vec {path};
+    REQUIRE(vec.size() == expected.size());
+    for (size_t i = 0; i < vec.size(); ++i) REQUIRE(vec[i] == expected[i]);
+
+    vec.push_back(1337);
+    expected.push_back(1337);
+
+    // Copies are anonymous.
+    auto copy = vec;
+    copy.push_back(false);
+    REQUIRE(copy.size() == vec.size() + 1);
+  }
+  {
+    mapped vec {path};
+    REQUIRE(vec.size() == expected.size());
+    REQUIRE(vec.back() == value {1337});
+  }
+
+  // Files are tagged with the type list.
+  using other = varvec::mapped_vector<int, float>;
+  REQUIRE_THROWS_AS(other {path}, std::invalid_argument);
+  REQUIRE_THROWS_AS(mapped {path / "missing"}, std::system_error);
+
+  // Default constructed instances are anonymous.
+  mapped anonymous;
+  for (int i = 0; i < 1000; ++i) anonymous.push_back(i);
+  REQUIRE(anonymous.size() == 1000);
+  REQUIRE(anonymous[999] == value {999});
+
+  std::filesystem::remove(path);
+}
+#endif
+
+// Counts how many times it's been constructed, copied, and moved.
+struct tracked {
+  tracked(int id, std::string name) : id(id), name(std::move(name)) {
+    ++constructions;
+  }
+  tracked(tracked const& other) : id(other.id), name(other.name) {
+    ++copies;
+  }
+  tracked(tracked&& other) noexcept : id(other.id), name(std::move(other.name)) {
+    ++moves;
+  }
+  tracked& operator =(tracked const&) = default;
+  tracked& operator =(tracked&&) = default;
+
+  bool operator ==(tracked const&) const = default;
+
+  static void reset() {
+    constructions = copies = moves = 0;
+  }
+
+  int id;
+  std::string name;
+
+  static inline int constructions = 0;
+  static inline int copies = 0;
+  static inline int moves = 0;
+};
+
+TEST_CASE("emplace", "varvec tests") {
+  using value = std::variant<int, double, std::string, tracked>;
+
+  auto test = [] <class V> (V vec) {
+    // push_back has to build a temporary.
+    tracked::reset();
+    vec.push_back(tracked {1, "one"});
+    REQUIRE(tracked::constructions == 1);
+    REQUIRE(tracked::moves == 1);
+
+    // emplace_back doesn't.
+    tracked::reset();
+    vec.template emplace_back<tracked>(2, "two");
+    vec.template emplace_back<std::string>(5, 'x');
+    vec.template emplace_back<double>(3);
+    REQUIRE(tracked::constructions == 1);
+    REQUIRE(tracked::moves == 0);
+    REQUIRE(tracked::copies == 0);
+    REQUIRE(vec.size() == 4);
+    REQUIRE(vec[1] == value {tracked {2, "two"}});
+    REQUIRE(vec[2] == value {"xxxxx"});
+    REQUIRE(vec[3] == value {3.0});
+
+    // Inserts only move the objects that have to shift.
+    tracked::reset();
+    vec.template emplace<tracked>(1, 3, "three");
+    vec.template emplace<int>(vec.begin(), 7);
+    vec.template emplace<std::string>(vec.size(), "end");
+    REQUIRE(tracked::constructions == 1);
+    REQUIRE(tracked::copies == 0);
+    REQUIRE(vec.size() == 7);
+    REQUIRE(vec[0] == value {7});
+    REQUIRE(vec[1] == value {tracked {1, "one"}});
+    REQUIRE(vec[2] == value {tracked {3, "three"}});
+    REQUIRE(vec[3] == value {tracked {2, "two"}});
+    REQUIRE(vec[4] == value {"xxxxx"});
+    REQUIRE(vec[6] == value {"end"});
   };
-  BENCHMARK("dynamic vector std::string get") {
-    return dvec.get<std::string>(3);
+
+  // Sized so nothing has to be moved by growth.
+  test(varvec::static_vector<512, 16, int, double, std::string, tracked> {});
+  test(varvec::vector<int, double, std::string, tracked> {16});
+  test(varvec::small_vector<512, 16, int, double, std::string, tracked> {});
+  test(varvec::block_vector<int, double, std::string, tracked> {16});
+
+  // Pushing a variant forwards its contents straight into place.
+  varvec::vector<int, double, std::string, tracked> vec;
+  tracked::reset();
+  vec.push_back(value {tracked {4, "four"}});
+  REQUIRE(tracked::constructions == 1);
+  REQUIRE(tracked::moves == 2);
+}
+
+TEST_CASE("bulk append", "varvec tests") {
+  using value = std::variant<bool, int, double, std::string>;
+
+  std::vector<value> values;
+  for (int i = 0; i < 1000; ++i) {
+    values.emplace_back(i % 2 == 0);
+    values.emplace_back(i);
+    values.emplace_back(i + 0.5);
+    values.emplace_back(std::to_string(i));
+  }
+
+  std::vector<int> ints(500);
+  std::iota(ints.begin(), ints.end(), 0);
+
+  auto test = [&] <class V> (varvec::meta::identity<V>) {
+    V vec {values};
+    REQUIRE(vec.size() == values.size());
+    for (size_t i = 0; i < values.size(); ++i) REQUIRE(vec[i] == values[i]);
+
+    // Homogeneous contiguous ranges are copied in one shot.
+    vec.append_range(std::span {ints});
+    REQUIRE(vec.size() == values.size() + ints.size());
+    REQUIRE(vec.back() == value {499});
+    REQUIRE(vec[values.size() + 10] == value {10});
+
+    // Values that have to be converted.
+    std::vector<char const*> strs {"a", "b", "c"};
+    vec.append_range(strs);
+    REQUIRE(vec.back() == value {"c"});
+
+    // Lazy ranges.
+    vec.append_range(std::views::iota(0, 10) | std::views::transform([] (int i) { return i * 0.5; }));
+    REQUIRE(vec.back() == value {4.5});
+
+    // Other varvecs.
+    V copy {vec};
+    auto const size = vec.size();
+    vec.append_range(copy);
+    REQUIRE(vec.size() == 2 * size);
+    for (size_t i = 0; i < size; ++i) REQUIRE(vec[i + size] == copy[i]);
+
+    vec.assign(std::span {ints}.first(3));
+    REQUIRE(vec.size() == 3);
+    REQUIRE(vec[2] == value {2});
+    vec.push_back("more");
+    REQUIRE(vec[3] == value {"more"});
+
+    vec.assign(std::vector<value> {});
+    REQUIRE(vec.empty());
   };
 
-  BENCHMARK("std::vector<std::variant> bool std::get") {
-    return std::get<bool>(vec[0]);
+  test(varvec::meta::identity<varvec::vector<bool, int, double, std::string>> {});
+  test(varvec::meta::identity<varvec::small_vector<64, 4, bool, int, double, std::string>> {});
+  test(varvec::meta::identity<varvec::block_vector<bool, int, double, std::string>> {});
+  test(varvec::meta::identity<varvec::static_vector<1 << 18, 1 << 14, bool, int, double, std::string>> {});
+
+  // Static vectors throw rather than overflowing.
+  varvec::static_vector<64, 8, bool, int, double, std::string> tiny;
+  REQUIRE_THROWS_AS(tiny.append_range(values), std::bad_alloc);
+  REQUIRE(tiny.empty());
+}
+
+TEST_CASE("reserve", "varvec tests") {
+  using value = std::variant<bool, int, double, std::string>;
+
+  auto test = [] <class V> (V vec) {
+    vec.reserve(16, 256);
+    REQUIRE(vec.capacity() >= 16);
+    REQUIRE(vec.byte_capacity() >= 256);
+
+    // Exactly sized for any ordering.
+    vec.template reserve_for<bool, int, double, std::string>(100, 100, 100, 100);
+    auto const capacity = vec.capacity();
+    auto const byte_capacity = vec.byte_capacity();
+    REQUIRE(capacity >= 400);
+    REQUIRE(byte_capacity >= 100 * (sizeof(bool) + sizeof(int) + sizeof(double) + sizeof(std::string)));
+    for (int i = 0; i < 100; ++i) {
+      vec.push_back(i % 2 == 0);
+      vec.push_back(std::to_string(i));
+      vec.push_back(i);
+      vec.push_back(i + 0.5);
+    }
+    REQUIRE(vec.capacity() == capacity);
+    REQUIRE(vec.byte_capacity() == byte_capacity);
+    REQUIRE(vec[397] == value {"99"});
+
+    // Reserving less than we have is a no-op.
+    vec.reserve(0, 0);
+    REQUIRE(vec.capacity() == capacity);
+    REQUIRE(vec.byte_capacity() == byte_capacity);
   };
-  BENCHMARK("std::vector<std::variant> int std::get") {
-    return std::get<int>(vec[1]);
+
+  test(varvec::vector<bool, int, double, std::string> {});
+  test(varvec::small_vector<64, 4, bool, int, double, std::string> {});
+  test(varvec::block_vector<bool, int, double, std::string> {});
+
+  // Trivially copyable types don't need any padding.
+  varvec::vector<bool, int, double> trivial;
+  trivial.reserve_for<bool, double>(10, 10);
+  REQUIRE(trivial.byte_capacity() == 10 * (sizeof(bool) + sizeof(double)));
+
+  // Static vectors can't grow.
+  varvec::static_vector<64, 8, bool, int, double> fixed;
+  fixed.reserve(8, 64);
+  REQUIRE_THROWS_AS(fixed.reserve(9, 64), std::bad_alloc);
+  REQUIRE_THROWS_AS(fixed.reserve_for<double>(9), std::bad_alloc);
+
+  // Reserving offset storage widens it once, up front.
+  varvec::storage::offsets::dynamic_offset_storage offsets {4};
+  offsets.set(0, 100);
+  offsets.reserve(8, 70'000);
+  REQUIRE(offsets.width == sizeof(uint32_t));
+  REQUIRE(offsets.capacity() == 8);
+  REQUIRE(offsets.get(0) == 100);
+  REQUIRE(offsets.can_handle(70'000));
+}
+
+TEST_CASE("type queries", "varvec tests") {
+  // Exercise every packed tag width, with enough members to cover the vectorized,
+  // word at a time, and partial word paths.
+  auto test = [] <class V, class Needle> (varvec::meta::identity<V>, varvec::meta::identity<Needle>) {
+    V vec;
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < 1000; ++i) {
+      if (i % 7 == 3 || i % 64 == 63) {
+        expected.push_back(i);
+        vec.push_back(Needle {});
+      } else {
+        vec.push_back(static_cast<int>(i));
+      }
+    }
+
+    REQUIRE(vec.template count_of<Needle>() == expected.size());
+    REQUIRE(vec.template positions_of<Needle>() == expected);
+    REQUIRE(vec.template find_first<Needle>() == expected.front());
+    for (size_t i = 0; i + 1 < expected.size(); ++i) {
+      REQUIRE(vec.template find_next<Needle>(expected[i] + 1) == expected[i + 1]);
+      REQUIRE(vec.template find_next<Needle>(expected[i]) == expected[i]);
+    }
+    REQUIRE(vec.template find_next<Needle>(expected.back() + 1) == vec.size());
+    REQUIRE(vec.template count_of<int>() == vec.size() - expected.size());
+    REQUIRE(vec.template find_first<int>() == 0);
+
+    // Trailing members are never miscounted as the first type.
+    V small;
+    small.push_back(5);
+    REQUIRE(small.template count_of<int>() == 1);
+    REQUIRE(small.template find_next<int>(1) == 1);
+    REQUIRE(small.template positions_of<Needle>().empty());
+  };
+
+  using id = varvec::meta::identity<char>;
+  test(varvec::meta::identity<varvec::vector<int, char>> {}, id {});
+  test(varvec::meta::identity<varvec::vector<int, short, long, char>> {}, id {});
+  test(varvec::meta::identity<varvec::vector<int, short, long, float, double, bool, long long, char>> {}, id {});
+  test(varvec::meta::identity<varvec::block_vector<int, short, long, float, double, bool, long long,
+      unsigned, unsigned short, unsigned long, unsigned char, signed char, long double, char16_t,
+      char32_t, wchar_t, char>> {}, id {});
+  test(varvec::meta::identity<varvec::static_vector<8192, 1024, int, short, long, char>> {}, id {});
+
+  // Views share the implementation.
+  varvec::vector<int, double> vec;
+  for (int i = 0; i < 100; ++i) {
+    if (i % 10) vec.push_back(i);
+    else vec.push_back(i * 0.5);
+  }
+  auto view = vec.view();
+  REQUIRE(view.count_of<double>() == 10);
+  REQUIRE(view.find_next<double>(11) == 20);
+  REQUIRE(view.positions_of<double>() == vec.positions_of<double>());
+}
+
+TEST_CASE("typed views", "varvec tests") {
+  using vector = varvec::vector<int, float, std::string>;
+
+  vector vec;
+  float expected = 0;
+  for (int i = 0; i < 500; ++i) {
+    switch (i % 3) {
+      case 0: vec.push_back(i); break;
+      case 1: vec.push_back(i * 0.5f); expected += i * 0.5f; break;
+      default: vec.push_back(std::to_string(i)); break;
+    }
+  }
+
+  auto floats = vec.view_of<float>();
+  static_assert(std::ranges::forward_range<decltype(floats)>);
+  static_assert(std::ranges::view<decltype(floats)>);
+  static_assert(std::is_same_v<std::ranges::range_reference_t<decltype(floats)>, float>);
+  REQUIRE(std::ranges::distance(floats) == static_cast<std::ptrdiff_t>(vec.count_of<float>()));
+  REQUIRE(std::accumulate(floats.begin(), floats.end(), 0.0f) == expected);
+  REQUIRE(floats.begin().index() == 1);
+
+  // Non-trivial types are yielded by reference, and can be mutated through the range.
+  static_assert(std::is_same_v<std::ranges::range_reference_t<decltype(vec.view_of<std::string>())>, std::string&>);
+  for (auto& str : vec.view_of<std::string>()) str += "!";
+  REQUIRE(vec[2] == vector::value_type {"2!"});
+
+  auto const& cvec = vec;
+  static_assert(std::is_same_v<
+    std::ranges::range_reference_t<decltype(cvec.view_of<std::string>())>,
+    std::string const&
+  >);
+  REQUIRE(std::ranges::all_of(cvec.view_of<std::string>(), [] (auto& str) { return str.back() == '!'; }));
+
+  // Composes with the standard library.
+  auto big = vec.view_of<int>() | std::views::filter([] (int i) { return i > 400; });
+  REQUIRE(std::ranges::distance(big) == 33);
+
+  // Types that aren't present produce empty ranges.
+  varvec::vector<int, float> ints;
+  ints.push_back(1);
+  REQUIRE(ints.view_of<float>().empty());
+  REQUIRE(varvec::vector<int, float> {}.view_of<int>().empty());
+
+  // Read-only views support it too.
+  varvec::vector<int, float> trivial;
+  for (int i = 0; i < 100; ++i) {
+    if (i % 2) trivial.push_back(i * 1.0f);
+    else trivial.push_back(i);
+  }
+  auto view = trivial.view();
+  REQUIRE(std::ranges::distance(view.view_of<float>()) == 50);
+  REQUIRE(*view.view_of<float>().begin() == 1.0f);
+}
+
+TEST_CASE("references", "varvec tests") {
+  using vector = varvec::vector<int, double, tracked>;
+  using value = vector::value_type;
+
+  vector vec {16};
+  vec.push_back(1);
+  vec.emplace_back<tracked>(2, "two");
+  vec.push_back(3.5);
+  vec.emplace_back<tracked>(4, "four");
+
+  static_assert(std::is_same_v<std::iter_reference_t<vector::iterator>, vector::reference>);
+  static_assert(std::forward_iterator<vector::iterator>);
+  static_assert(std::ranges::forward_range<vector>);
+
+  // Walking the vector reads members in place.
+  tracked::reset();
+  int ids = 0;
+  for (auto ref : vec) {
+    ref.visit(varvec::overload {
+      [&] (tracked const& t) { ids += t.id; },
+      [] (auto const&) {}
+    });
+  }
+  REQUIRE(ids == 6);
+  REQUIRE(tracked::copies == 0);
+
+  auto ref = *(vec.begin() + 1);
+  REQUIRE(ref.index() == 2);
+  REQUIRE(ref.holds_alternative<tracked>());
+  REQUIRE(!ref.holds_alternative<int>());
+  REQUIRE(ref.visit([] (auto const& val) { return sizeof(val); }) == sizeof(tracked));
+
+  // Comparisons don't copy either.
+  REQUIRE(ref == value {tracked {2, "two"}});
+  REQUIRE(ref != value {tracked {2, "deux"}});
+  REQUIRE(*vec.begin() == value {1});
+  REQUIRE(*vec.begin() != value {1.0});
+  REQUIRE(*(vec.begin() + 2) == *(vec.begin() + 2));
+  REQUIRE(*(vec.begin() + 1) != *(vec.begin() + 3));
+  tracked::reset();
+  REQUIRE(vec == vec);
+  REQUIRE(tracked::copies == 0);
+
+  // A value is only materialized when asked for.
+  value copy = *(vec.begin() + 3);
+  REQUIRE(tracked::copies == 1);
+  REQUIRE(std::get<tracked>(copy).name == "four");
+
+  // References can be fed back into vectors.
+  vector other;
+  other.push_back(*vec.begin());
+  other.append_range(vec);
+  REQUIRE(other.size() == 5);
+  REQUIRE(other[1] == vec[0]);
+  REQUIRE(other[4] == vec[3]);
+
+  varvec::small_vector<256, 8, int, double, tracked> small {vec};
+  REQUIRE(std::equal(small.begin(), small.end(), vec.begin()));
+}
+
+TEST_CASE("bulk visitation", "varvec tests") {
+  auto test = [] <class V> (varvec::meta::identity<V>) {
+    V vec;
+    for (int i = 0; i < 300; ++i) {
+      switch (i % 4) {
+        case 0: vec.push_back(i); break;
+        case 1: vec.push_back(static_cast<double>(i)); break;
+        case 2: vec.push_back(i % 3 == 0); break;
+        default: vec.push_back(static_cast<float>(i)); break;
+      }
+    }
+
+    auto expected = [&] (size_t first, size_t last) {
+      std::vector<double> vals;
+      for (auto i = first; i < last; ++i) vec.visit(i, [&] (auto const& val) { vals.push_back(val); });
+      return vals;
+    };
+
+    // Ranges starting and ending partway through a word of type tags.
+    for (auto [first, last] : {std::pair<size_t, size_t> {0, 300},
+        {0, 0}, {1, 2}, {7, 65}, {31, 33}, {64, 128}, {250, 300}}) {
+      std::vector<double> vals;
+      std::as_const(vec).visit_range(first, last, [&] (auto const& val) { vals.push_back(val); });
+      REQUIRE(vals == expected(first, last));
+    }
+
+    // Mutation.
+    vec.visit_all(varvec::overload {
+      [] (double& val) { val *= 2; },
+      [] (auto&) {}
+    });
+    REQUIRE(std::get<double>(vec[1]) == 2.0);
+    REQUIRE(std::get<double>(vec[297]) == 594.0);
+
+    auto counter = vec.for_each([n = 0] (auto const&) mutable { return ++n; });
+    REQUIRE(counter(0) == 301);
+
+    std::vector<double> vals;
+    vec.visit_range(vec.begin() + 3, vec.end() - 1, [&] (auto const& val) { vals.push_back(val); });
+    REQUIRE(vals == expected(3, 299));
+  };
+  test(varvec::meta::identity<varvec::vector<int, double, bool, float>> {});
+  test(varvec::meta::identity<varvec::static_vector<4096, 512, int, double, bool, float>> {});
+  test(varvec::meta::identity<varvec::small_vector<64, 8, int, double, bool, float>> {});
+  test(varvec::meta::identity<varvec::vector<int, double, bool, float, char, short, long, unsigned>> {});
+
+  // Views visit the same way.
+  varvec::vector<int, float> vec;
+  for (int i = 0; i < 100; ++i) {
+    if (i % 3) vec.push_back(i);
+    else vec.push_back(i * 0.5f);
+  }
+  double sum = 0;
+  vec.view().visit_all([&] (auto const& val) { sum += val; });
+  REQUIRE(sum == vec.for_each([sum = 0.0] (auto const& val) mutable { sum += val; return sum; })(0));
+  sum = 0;
+  vec.view().visit_range(10, 20, [&] (auto const& val) { sum += val; });
+  REQUIRE(sum == 10 + 11 + 13 + 14 + 16 + 17 + 19 + 6 + 7.5 + 9);
+}
+
+TEST_CASE("grouped visitation", "varvec tests") {
+  auto test = [] <class V> (varvec::meta::identity<V>) {
+    V vec;
+    int64_t int_sum = 0;
+    double double_sum = 0;
+    for (int i = 0; i < 300; ++i) {
+      if (i % 5 == 0 || (i > 100 && i < 200)) {
+        vec.push_back(static_cast<double>(i));
+        double_sum += i;
+      } else if (i % 7 == 0) {
+        vec.push_back(std::to_string(i));
+      } else {
+        vec.push_back(i);
+        int_sum += i;
+      }
+    }
+
+    // Groups come out one type at a time, each in index order.
+    std::vector<size_t> kinds;
+    int64_t ints = 0;
+    double doubles = 0;
+    std::as_const(vec).visit_grouped(varvec::overload {
+      [&] (int val) { ints += val; kinds.push_back(0); },
+      [&] (double val) { doubles += val; kinds.push_back(1); },
+      [&] (std::string const&) { kinds.push_back(2); }
+    });
+    REQUIRE(ints == int_sum);
+    REQUIRE(doubles == double_sum);
+    REQUIRE(kinds.size() == vec.size());
+    REQUIRE(std::ranges::is_sorted(kinds));
+
+    // Batches see every member exactly once, and contiguous runs arrive together.
+    ints = 0;
+    doubles = 0;
+    size_t strings = 0, largest_run = 0;
+    std::as_const(vec).visit_batched(varvec::overload {
+      [&] (std::span<int const> vals) { for (auto val : vals) ints += val; },
+      [&] (std::span<double const> vals) {
+        for (auto val : vals) doubles += val;
+        largest_run = std::max(largest_run, vals.size());
+      },
+      [&] (std::span<std::string const> vals) { strings += vals.size(); }
+    });
+    REQUIRE(ints == int_sum);
+    REQUIRE(doubles == double_sum);
+    REQUIRE(strings == vec.template count_of<std::string>());
+    REQUIRE(largest_run > 1);
+
+    // Mutation, through misaligned members too.
+    vec.visit_batched(varvec::overload {
+      [] (std::span<int> vals) { for (auto& val : vals) val = -val; },
+      [] (std::span<double> vals) { for (auto& val : vals) val *= 2; },
+      [] (std::span<std::string> vals) { for (auto& val : vals) val += "!"; }
+    });
+    vec.visit_grouped(varvec::overload {
+      [] (double& val) { val /= 2; },
+      [] (auto&) {}
+    });
+    REQUIRE(std::get<int>(vec[1]) == -1);
+    REQUIRE(std::get<double>(vec[150]) == 150.0);
+    REQUIRE(std::get<std::string>(vec[7]) == "7!");
+  };
+  test(varvec::meta::identity<varvec::vector<int, double, std::string>> {});
+  test(varvec::meta::identity<varvec::small_vector<128, 8, int, double, std::string>> {});
+  test(varvec::meta::identity<varvec::static_vector<8192, 512, int, double, std::string>> {});
+}
+
+TEST_CASE("dispatch", "varvec tests") {
+  // Long enough type lists switch over to table dispatch, which should be invisible.
+  static_assert(40 > varvec::storage::dispatch_table_threshold);
+  tagged_list_t<varvec::vector, 40> vec;
+  auto fill = [&] <size_t... tags> (std::index_sequence<tags...>) {
+    for (int64_t i = 0; i < 4; ++i) (vec.push_back(tagged<tags> {i}), ...);
+  };
+  fill(std::make_index_sequence<40> {});
+  REQUIRE(vec.size() == 160);
+
+  auto tag_of = [] (auto const& vec, size_t idx) {
+    size_t tag = 0;
+    vec.visit(idx, [&] <size_t t> (tagged<t> const&) { tag = t; });
+    return tag;
+  };
+  for (size_t i = 0; i < vec.size(); ++i) {
+    REQUIRE(tag_of(vec, i) == i % 40);
+  }
+  REQUIRE(vec.get<tagged<39>>(79) == tagged<39> {1});
+
+  auto copy = vec;
+  REQUIRE(copy == vec);
+  copy.erase(0);
+  REQUIRE(tag_of(copy, 0) == 1);
+  REQUIRE(tag_of(copy, 158) == 39);
+
+  // Both strategies should agree, including past the 256 types a packed tag can address.
+  using wide = tagged_list_t<std::variant, 300>;
+  auto check = [&] <size_t tag> (varvec::meta::identity<tagged<tag>>) {
+    tagged<tag> val {static_cast<int64_t>(tag)};
+    auto get_tag = [] <size_t t> (tagged<t>* ptr) { return t + ptr->value; };
+    auto chained = varvec::storage::get_typed_ptr_by_comparison(tag,
+        &val, varvec::meta::identity<wide> {}, get_tag);
+    auto tabled = varvec::storage::get_typed_ptr_by_table(tag,
+        &val, varvec::meta::identity<wide> {}, get_tag);
+    REQUIRE(chained == tag * 2);
+    REQUIRE(tabled == tag * 2);
+  };
+  check(varvec::meta::identity<tagged<0>> {});
+  check(varvec::meta::identity<tagged<17>> {});
+  check(varvec::meta::identity<tagged<255>> {});
+  check(varvec::meta::identity<tagged<256>> {});
+  check(varvec::meta::identity<tagged<299>> {});
+}
+
+TEST_CASE("dispatch hints", "varvec tests") {
+  varvec::storage::reset_dispatch_counts<skewed_variant>();
+
+  varvec::vector<bool, tagged<1>, std::string, tagged<2>> vec;
+  for (int64_t i = 0; i < 8; ++i) vec.push_back(tagged<2> {i});
+  vec.push_back(tagged<1> {8});
+  vec.push_back(std::string {"cold"});
+  vec.push_back(true);
+
+  // Hints only reorder the checks, type indices are unchanged.
+  REQUIRE(vec[0].index() == 3);
+  REQUIRE(vec[8].index() == 1);
+  REQUIRE(vec[9].index() == 2);
+  REQUIRE(vec.get<tagged<2>>(7) == tagged<2> {7});
+  REQUIRE(vec.get<tagged<1>>(8) == tagged<1> {8});
+  REQUIRE(vec.get<std::string>(9) == "cold");
+  REQUIRE(vec.get<bool>(10));
+
+  varvec::storage::reset_dispatch_counts<skewed_variant>();
+  size_t total = 0;
+  vec.visit_all(varvec::overload {
+    [&] (std::string const& str) { total += str.size(); },
+    [&] <size_t tag> (tagged<tag> const& val) { total += val.value; },
+    [&] (bool val) { total += val; }
+  });
+  REQUIRE(total == 28 + 8 + 4 + 1);
+
+  auto counts = varvec::storage::dispatch_counts<skewed_variant>();
+  REQUIRE(counts[0] == 1);
+  REQUIRE(counts[1] == 1);
+  REQUIRE(counts[2] == 1);
+  REQUIRE(counts[3] == 8);
+
+  varvec::storage::reset_dispatch_counts<skewed_variant>();
+  REQUIRE(varvec::storage::dispatch_counts<skewed_variant>()[3] == 0);
+}
+
+TEST_CASE("parallel", "varvec tests") {
+  static_assert(std::random_access_iterator<varvec::vector<int, double>::iterator>);
+  static_assert(std::random_access_iterator<varvec::vector_view<int, double>::iterator>);
+
+  varvec::vector<bool, int, double, std::string> vec;
+  for (int i = 0; i < 10'000; ++i) {
+    switch (i % 4) {
+      case 0: vec.push_back(i % 3 == 0); break;
+      case 1: vec.push_back(i); break;
+      case 2: vec.push_back(i * 0.5); break;
+      default: vec.push_back(std::to_string(i)); break;
+    }
+  }
+  REQUIRE(vec.end() - vec.begin() == 10'000);
+  REQUIRE((vec.begin() + 5)[2] == vec[7]);
+
+  auto value_of = varvec::overload {
+    [] (std::string const& str) { return static_cast<double>(str.size()); },
+    [] (auto const& val) { return static_cast<double>(val); }
+  };
+  double serial = 0;
+  vec.visit_all([&] (auto const& val) { serial += value_of(val); });
+
+  // Small chunks, so every thread count actually splits the work.
+  for (size_t threads : {1, 2, 3, 8}) {
+    auto sum = varvec::parallel::transform_reduce(vec, 0.0, std::plus {}, value_of, threads, 64);
+    REQUIRE(sum == serial);
+  }
+  REQUIRE(varvec::parallel::transform_reduce(vec.view(), 0.0, std::plus {}, value_of, 4, 100) == serial);
+
+  // Mutating visitation, on disjoint members.
+  varvec::parallel::for_each(vec, varvec::overload {
+    [] (int& val) { val = -val; },
+    [] (auto&) {}
+  }, 4, 128);
+  for (size_t i = 1; i < vec.size(); i += 4) {
+    REQUIRE(vec.get<int>(i) == -static_cast<int>(i));
+  }
+
+  std::atomic<size_t> visited {0};
+  varvec::parallel::for_each(std::as_const(vec), [&] (auto const&) { ++visited; }, 3, 1000);
+  REQUIRE(visited == vec.size());
+
+  // Exceptions are rethrown on the calling thread.
+  auto throws = [&] {
+    varvec::parallel::for_each(vec, varvec::overload {
+      [] (std::string& str) { if (str == "5003") throw std::runtime_error("visit failed"); },
+      [] (auto&) {}
+    }, 4, 64);
+  };
+  REQUIRE_THROWS_AS(throws(), std::runtime_error);
+
+  varvec::vector<int, double> empty;
+  REQUIRE(varvec::parallel::transform_reduce(empty, 5, std::plus {}, [] (auto val) { return 1; }) == 5);
+}
+
+TEST_CASE("segmented vector", "varvec tests") {
+  using segmented = varvec::segmented_vector<256, 16, bool, int, double, std::string>;
+  segmented vec;
+  REQUIRE(vec.empty());
+
+  for (int i = 0; i < 1000; ++i) {
+    switch (i % 4) {
+      case 0: vec.push_back(i % 3 == 0); break;
+      case 1: vec.push_back(i); break;
+      case 2: vec.emplace_back<double>(i * 0.5); break;
+      default: vec.push_back(std::to_string(i)); break;
+    }
+  }
+  REQUIRE(vec.size() == 1000);
+  REQUIRE(vec.chunk_count() > 1000 / 16);
+
+  // Addresses stay put as the vector grows.
+  auto* first_string = &vec.get<std::string>(3);
+  for (int i = 0; i < 1000; ++i) vec.push_back(std::string(40, 'x'));
+  REQUIRE(first_string == &vec.get<std::string>(3));
+  REQUIRE(*first_string == "3");
+
+  for (size_t i = 0; i < 1000; ++i) {
+    switch (i % 4) {
+      case 0: REQUIRE(vec.get<bool>(i) == (i % 3 == 0)); break;
+      case 1: REQUIRE(vec.get<int>(i) == static_cast<int>(i)); break;
+      case 2: REQUIRE(std::get<double>(vec[i]) == i * 0.5); break;
+      default: REQUIRE(vec.get<std::string>(i) == std::to_string(i)); break;
+    }
+  }
+
+  size_t chunked = 0;
+  for (size_t c = 0; c < vec.chunk_count(); ++c) {
+    REQUIRE(vec.chunk_start(c) == chunked);
+    chunked += vec.chunk(c).size();
+  }
+  REQUIRE(chunked == vec.size());
+
+  // Ranges that straddle chunk boundaries.
+  size_t visited = 0;
+  vec.visit_range(5, 1500, [&] (auto const&) { ++visited; });
+  REQUIRE(visited == 1495);
+  vec.visit(1, [] (auto& val) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(val)>, int>) val = -1;
+  });
+  REQUIRE(vec.get<int>(1) == -1);
+
+  auto counted = varvec::parallel::transform_reduce(vec, size_t {0},
+      std::plus {}, [] (auto const&) { return size_t {1}; }, 3, 100);
+  REQUIRE(counted == vec.size());
+
+  auto copy = vec;
+  REQUIRE(copy == vec);
+  REQUIRE(std::distance(copy.begin(), copy.end()) == 2000);
+  copy.push_back(true);
+  REQUIRE(copy != vec);
+
+  while (vec.size() > 10) vec.pop_back();
+  REQUIRE(vec.chunk_count() == 1);
+  REQUIRE(vec.get<std::string>(3) == "3");
+  auto moved = std::move(vec);
+  REQUIRE(moved.size() == 10);
+  REQUIRE(vec.empty());
+  moved.clear();
+  REQUIRE(moved.empty());
+  REQUIRE(moved.chunk_count() == 0);
+}
+
+#ifdef __linux__
+TEST_CASE("mapped growth", "varvec tests") {
+  using allocator = varvec::storage::default_allocator;
+  constexpr auto threshold = varvec::storage::mapping_threshold;
+
+  // Small buffers come from operator new, and can't be remapped.
+  auto* small = allocator::allocate(64, 8);
+  REQUIRE(!allocator::try_reallocate(small, 64, 128, 8));
+  allocator::deallocate(small, 64, 8);
+
+  // Large ones keep their contents across a remap.
+  auto* large = allocator::allocate(threshold, 16);
+  REQUIRE(varvec::storage::aligned_for(large, 16));
+  for (size_t i = 0; i < threshold; i += 4096) large[i] = static_cast<uint8_t>(i / 4096);
+  auto* grown = allocator::try_reallocate(large, threshold, threshold * 4, 16);
+  REQUIRE(grown);
+  for (size_t i = 0; i < threshold; i += 4096) REQUIRE(grown[i] == static_cast<uint8_t>(i / 4096));
+  allocator::deallocate(grown, threshold * 4, 16);
+
+  // Vectors growing across the threshold in both directions.
+  varvec::vector<bool, int, double> vec;
+  constexpr int members = threshold / 4;
+  for (int i = 0; i < members; ++i) {
+    if (i % 5) vec.push_back(i);
+    else vec.push_back(i * 0.5);
+  }
+  REQUIRE(vec.byte_capacity() >= threshold);
+  auto copy = vec;
+  for (int i = 0; i < members; i += 7) {
+    if (i % 5) REQUIRE(vec.get<int>(i) == i);
+    else REQUIRE(vec.get<double>(i) == i * 0.5);
+  }
+  REQUIRE(copy == vec);
+  REQUIRE(copy.get<int>(members - 1) == members - 1);
+}
+#endif
+
+TEST_CASE("insert and erase", "varvec tests") {
+  auto asserts = [] <class V> (varvec::meta::identity<V>) {
+    using val = typename V::value_type;
+
+    V vec;
+    vec.push_back("a long enough string that the small string optimization won't apply");
+    vec.push_back("a long enough string that the small string optimization won't apply");
+    vec.insert(0, true);
+    vec.insert(1, false);
+    vec.push_back("a long enough string that the small string optimization won't apply");
+    vec.insert(3, 3.5f);
+    vec.insert(6, "a final value");
+
+    REQUIRE(vec.size() == 7);
+    REQUIRE(vec[0] == val {true});
+    REQUIRE(vec[1] == val {false});
+    REQUIRE(vec[2] == val {"a long enough string that the small string optimization won't apply"});
+    REQUIRE(vec[3] == val {3.5f});
+    REQUIRE(vec[4] == val {"a long enough string that the small string optimization won't apply"});
+    REQUIRE(vec[5] == val {"a long enough string that the small string optimization won't apply"});
+    REQUIRE(vec[6] == val {"a final value"});
+
+    auto it = vec.erase(0);
+    it = vec.erase(it);
+    it = vec.erase(it);
+    REQUIRE(vec.size() == 4);
+    REQUIRE(vec[0] == val {3.5f});
+    REQUIRE(vec[1] == val {"a long enough string that the small string optimization won't apply"});
+    REQUIRE(vec[2] == val {"a long enough string that the small string optimization won't apply"});
+    REQUIRE(vec[3] == val {"a final value"});
+
+    it = vec.erase(it);
+    it = vec.erase(it);
+    it = vec.erase(it);
+    REQUIRE(vec.size() == 1);
+    REQUIRE(vec[0] == val {"a final value"});
+
+    it = vec.erase(it);
+    REQUIRE(vec.size() == 0);
+    REQUIRE(it == vec.end());
+    for (auto v : vec) REQUIRE(false);
+  };
+  asserts(varvec::meta::identity<copyable_vector> {});
+  asserts(varvec::meta::identity<movable_vector> {});
+  asserts(varvec::meta::identity<dynamic_copyable_vector> {});
+  asserts(varvec::meta::identity<dynamic_movable_vector> {});
+  asserts(varvec::meta::identity<small_copyable_vector> {});
+  asserts(varvec::meta::identity<small_movable_vector> {});
+  asserts(varvec::meta::identity<block_copyable_vector> {});
+  asserts(varvec::meta::identity<block_movable_vector> {});
+}
+
+TEST_CASE("range erase", "varvec tests") {
+  auto asserts = [] <class V> (varvec::meta::identity<V>) {
+    using val = typename V::value_type;
+
+    V vec;
+    std::vector<val> expected;
+    for (int i = 0; i < 40; ++i) {
+      switch (i % 4) {
+        case 0: vec.push_back(i % 3 == 0); expected.push_back(i % 3 == 0); break;
+        case 1: vec.push_back(i); expected.push_back(i); break;
+        case 2: vec.push_back(i * 0.5f); expected.push_back(i * 0.5f); break;
+        default:
+          vec.push_back("string number " + std::to_string(i) + " is too long for small string storage");
+          expected.push_back("string number " + std::to_string(i) + " is too long for small string storage");
+          break;
+      }
+    }
+    auto matches = [&] {
+      REQUIRE(vec.size() == expected.size());
+      for (size_t i = 0; i < vec.size(); ++i) REQUIRE(vec[i] == expected[i]);
+    };
+
+    // Shifts the strings back by less than their own size.
+    vec.erase(1);
+    expected.erase(expected.begin() + 1);
+    matches();
+
+    auto it = vec.erase(vec.begin() + 3, vec.begin() + 9);
+    expected.erase(expected.begin() + 3, expected.begin() + 9);
+    REQUIRE(it == vec.begin() + 3);
+    matches();
+
+    REQUIRE(vec.erase(5, 5) == vec.begin() + 5);
+    matches();
+
+    auto removed = varvec::erase_if(vec, varvec::overload {
+      [] (int val) { return val % 3 == 0; },
+      [] (std::string const& str) { return str.find('7') != std::string::npos; },
+      [] (auto const&) { return false; }
+    });
+    auto expected_removed = std::erase_if(expected, [] (auto const& v) {
+      if (auto* num = std::get_if<int>(&v)) return *num % 3 == 0;
+      if (auto* str = std::get_if<std::string>(&v)) return str->find('7') != std::string::npos;
+      return false;
+    });
+    REQUIRE(removed == expected_removed);
+    matches();
+
+    // Survivors stay usable after being moved.
+    vec.push_back(true);
+    expected.push_back(true);
+    vec.insert(1, 2.5f);
+    expected.insert(expected.begin() + 1, 2.5f);
+    matches();
+
+    // A throwing predicate keeps everything it hadn't been asked about.
+    size_t calls = 0;
+    auto throws = [&] {
+      vec.remove_if([&] (auto const&) {
+        if (++calls == 4) throw std::runtime_error("predicate failed");
+        return calls % 2 == 0;
+      });
+    };
+    REQUIRE_THROWS_AS(throws(), std::runtime_error);
+    expected.erase(expected.begin() + 1);
+    REQUIRE(vec.size() == expected.size());
+    matches();
+
+    vec.erase(vec.begin(), vec.end());
+    REQUIRE(vec.empty());
+    vec.push_back(7);
+    REQUIRE(vec[0] == val {7});
+  };
+  asserts(varvec::meta::identity<varvec::static_vector<4096, 64, bool, int, float, std::string>> {});
+  asserts(varvec::meta::identity<dynamic_copyable_vector> {});
+  asserts(varvec::meta::identity<small_copyable_vector> {});
+  asserts(varvec::meta::identity<block_copyable_vector> {});
+}
+
+TEST_CASE("range insert", "varvec tests") {
+  auto asserts = [] <class V> (varvec::meta::identity<V>) {
+    using val = typename V::value_type;
+    auto const long_string = std::string {"a long enough string that the small string optimization won't apply"};
+
+    V vec;
+    std::vector<val> expected;
+    for (int i = 0; i < 8; ++i) {
+      if (i % 2) {
+        vec.push_back(long_string);
+        expected.push_back(long_string);
+      } else {
+        vec.push_back(i % 4 == 0);
+        expected.push_back(i % 4 == 0);
+      }
+    }
+    auto matches = [&] {
+      REQUIRE(vec.size() == expected.size());
+      for (size_t i = 0; i < vec.size(); ++i) REQUIRE(vec[i] == expected[i]);
+    };
+
+    // Values of a single type, constructed in place.
+    std::vector<int> ints {1, 2, 3, 4, 5};
+    auto it = vec.insert_range(3, ints);
+    expected.insert(expected.begin() + 3, ints.begin(), ints.end());
+    REQUIRE(it == vec.begin() + 3);
+    matches();
+
+    // Variants, with alignment to work out between members.
+    std::vector<val> mixed {val {1.5f}, val {long_string}, val {true}, val {7}, val {long_string}};
+    vec.insert_range(vec.begin() + 1, mixed);
+    expected.insert(expected.begin() + 1, mixed.begin(), mixed.end());
+    matches();
+
+    // Proxy references from another vector.
+    V other;
+    other.push_back(9);
+    other.push_back(long_string);
+    other.push_back(false);
+    vec.insert_range(0, other.begin(), other.end());
+    expected.insert(expected.begin(), {val {9}, val {long_string}, val {false}});
+    matches();
+
+    // Throwing conversions and single pass ranges go through a temporary.
+    std::vector<char const*> strs {"first", "second"};
+    vec.insert_range(4, strs);
+    expected.insert(expected.begin() + 4, {val {"first"}, val {"second"}});
+    matches();
+
+    std::istringstream stream {"10 20 30"};
+    vec.insert_range(2, std::views::istream<int>(stream));
+    expected.insert(expected.begin() + 2, {val {10}, val {20}, val {30}});
+    matches();
+
+    vec.insert_range(5, std::vector<int> {});
+    vec.insert_range(vec.size(), std::vector<int> {42});
+    expected.push_back(42);
+    matches();
+
+    vec.erase(0, 3);
+    expected.erase(expected.begin(), expected.begin() + 3);
+    matches();
+  };
+  asserts(varvec::meta::identity<varvec::static_vector<4096, 64, bool, int, float, std::string>> {});
+  asserts(varvec::meta::identity<dynamic_copyable_vector> {});
+  asserts(varvec::meta::identity<small_copyable_vector> {});
+  asserts(varvec::meta::identity<block_copyable_vector> {});
+
+  // Large enough to grow the storage and widen the offsets.
+  varvec::vector<bool, int> wide;
+  wide.push_back(true);
+  wide.push_back(false);
+  std::vector<int> ints(1000);
+  std::iota(ints.begin(), ints.end(), 0);
+  wide.insert_range(1, ints);
+  REQUIRE(wide.size() == 1002);
+  REQUIRE(wide.get<bool>(0));
+  for (int i = 0; i < 1000; ++i) REQUIRE(wide.get<int>(i + 1) == i);
+  REQUIRE(!wide.get<bool>(1001));
+}
+
+TEST_CASE("coalesced shifts", "varvec tests") {
+  using val = std::variant<bool, int, double, std::string>;
+  auto const long_string = std::string {"a long enough string that the small string optimization won't apply"};
+
+  // Long runs of trivially copyable members, broken up by the occasional string.
+  varvec::vector<bool, int, double, std::string> vec;
+  std::vector<val> expected;
+  for (int i = 0; i < 200; ++i) {
+    val v;
+    if (i % 37 == 0) v = long_string + std::to_string(i);
+    else if (i % 3 == 0) v = i * 0.5;
+    else if (i % 3 == 1) v = i;
+    else v = bool(i % 2);
+    vec.push_back(v);
+    expected.push_back(v);
+  }
+  auto matches = [&] {
+    REQUIRE(vec.size() == expected.size());
+    for (size_t i = 0; i < vec.size(); ++i) REQUIRE(vec[i] == expected[i]);
+  };
+
+  for (size_t idx : {0, 1, 36, 37, 38, 150}) {
+    vec.insert(idx, 7);
+    expected.insert(expected.begin() + idx, 7);
+    matches();
+    vec.insert(idx, long_string);
+    expected.insert(expected.begin() + idx, long_string);
+    matches();
+  }
+
+  vec.erase(1, 40);
+  expected.erase(expected.begin() + 1, expected.begin() + 40);
+  matches();
+
+  // Drop members from the middle of runs, so the survivors split into several runs.
+  auto drop = [] (auto const& v) {
+    return std::visit([] <class T> (T const& v) {
+      if constexpr (std::is_same_v<T, int>) return v % 4 == 0;
+      else return false;
+    }, v);
+  };
+  vec.remove_if([] <class T> (T const& v) {
+    if constexpr (std::is_same_v<T, int>) return v % 4 == 0;
+    else return false;
+  });
+  std::erase_if(expected, drop);
+  matches();
+
+  // All trivially copyable, so every shift is a single run.
+  varvec::vector<bool, int, double> trivial;
+  for (int i = 0; i < 100; ++i) {
+    if (i % 2) trivial.push_back(i);
+    else trivial.push_back(i * 0.5);
+  }
+  trivial.insert(0, true);
+  trivial.erase(50, 60);
+  REQUIRE(trivial.size() == 91);
+  REQUIRE(trivial.get<bool>(0));
+  for (int i = 0; i < 90; ++i) {
+    auto const orig = i < 49 ? i : i + 10;
+    if (orig % 2) REQUIRE(trivial.get<int>(i + 1) == orig);
+    else REQUIRE(trivial.get<double>(i + 1) == orig * 0.5);
+  }
+}
+
+TEST_CASE("compact", "varvec tests") {
+  auto asserts = [] <class V> (varvec::meta::identity<V>, bool shrinks) {
+    auto const long_string = std::string {"a long enough string that the small string optimization won't apply"};
+
+    // Churn the vector with edits that leave slack behind.
+    V vec;
+    for (int i = 0; i < 24; ++i) {
+      if (i % 4 == 0) vec.push_back(long_string);
+      else if (i % 4 == 1) vec.push_back(i);
+      else vec.push_back(i % 2 == 0);
+    }
+    vec.insert(3, long_string);
+    vec.insert(0, true);
+    vec.erase(5, 9);
+    for (int i = 0; i < 3; ++i) vec.pop_back();
+    vec.push_back(1.5f);
+
+    // The same members, appended in order.
+    V fresh;
+    for (auto const& val : vec) fresh.push_back(val);
+
+    auto const before = vec.used_bytes();
+    auto const freed = vec.compact(true);
+    REQUIRE(freed == before - vec.used_bytes());
+    REQUIRE(vec == fresh);
+    if (shrinks) {
+      fresh.shrink_to_fit();
+      REQUIRE(vec.used_bytes() == fresh.used_bytes());
+    }
+
+    // Already minimal.
+    REQUIRE(vec.compact() == 0);
+    REQUIRE(vec == fresh);
+
+    // And still usable afterwards.
+    vec.push_back(long_string);
+    fresh.push_back(long_string);
+    REQUIRE(vec == fresh);
+
+    V empty;
+    REQUIRE(empty.compact() == 0);
+  };
+  asserts(varvec::meta::identity<varvec::static_vector<4096, 64, bool, int, float, std::string>> {}, false);
+  asserts(varvec::meta::identity<dynamic_copyable_vector> {}, true);
+  asserts(varvec::meta::identity<small_copyable_vector> {}, false);
+  asserts(varvec::meta::identity<block_copyable_vector> {}, true);
+}
+
+TEST_CASE("truncate and clear", "varvec tests") {
+  auto asserts = [] <class V> (varvec::meta::identity<V>) {
+    auto const long_string = std::string {"a long enough string that the small string optimization won't apply"};
+
+    V vec;
+    for (int i = 0; i < 16; ++i) {
+      if (i % 2) vec.push_back(long_string);
+      else vec.push_back(i);
+    }
+
+    // A push/pop workload shouldn't creep through the buffer once it's warmed up.
+    vec.push_back(long_string);
+    vec.push_back(true);
+    vec.pop_back();
+    vec.pop_back();
+    auto const capacity = vec.byte_capacity();
+    for (int i = 0; i < 1000; ++i) {
+      vec.push_back(long_string);
+      vec.push_back(true);
+      vec.pop_back();
+      vec.pop_back();
+    }
+    REQUIRE(vec.size() == 16);
+    REQUIRE(vec.byte_capacity() == capacity);
+    REQUIRE(vec.compact() == 0);
+
+    vec.truncate(5);
+    REQUIRE(vec.size() == 5);
+    REQUIRE(vec.template get<int>(4) == 4);
+    REQUIRE(vec.template get<std::string>(3) == long_string);
+    REQUIRE(vec.compact() == 0);
+    vec.truncate(10);
+    REQUIRE(vec.size() == 5);
+
+    vec.clear();
+    REQUIRE(vec.empty());
+    REQUIRE(vec.byte_capacity() == capacity);
+    for (int i = 0; i < 16; ++i) vec.push_back(long_string);
+    REQUIRE(vec.byte_capacity() == capacity);
+    REQUIRE(vec.template get<std::string>(15) == long_string);
+  };
+  asserts(varvec::meta::identity<varvec::static_vector<4096, 64, bool, int, float, std::string>> {});
+  asserts(varvec::meta::identity<dynamic_copyable_vector> {});
+  asserts(varvec::meta::identity<small_copyable_vector> {});
+  asserts(varvec::meta::identity<block_copyable_vector> {});
+
+  // Truncated members are destroyed, exactly once.
+  auto ptr = std::make_shared<int>(5);
+  {
+    varvec::vector<int, std::shared_ptr<int>> owners;
+    for (int i = 0; i < 8; ++i) {
+      owners.push_back(ptr);
+      owners.push_back(i);
+    }
+    REQUIRE(ptr.use_count() == 9);
+    owners.truncate(6);
+    REQUIRE(ptr.use_count() == 4);
+    owners.pop_back();
+    owners.pop_back();
+    REQUIRE(ptr.use_count() == 3);
+    owners.clear();
+    REQUIRE(ptr.use_count() == 1);
+    owners.push_back(ptr);
+  }
+  REQUIRE(ptr.use_count() == 1);
+}
+
+#ifdef VARVEC_BENCHMARK
+TEST_CASE("performance", "varvec benchmarks") {
+  copyable_vector vec;
+  dynamic_copyable_vector dvec;
+  std::vector<std::variant<bool, int, float, std::string>> stdvec;
+
+  vec.push_back(bool(rand() % 2));
+  vec.push_back(rand());
+  vec.push_back(0.5f + rand());
+  vec.push_back("hello world" + std::to_string(rand()));
+
+  dvec.push_back(bool(rand() % 2));
+  dvec.push_back(rand());
+  dvec.push_back(0.5f + rand());
+  dvec.push_back("hello world" + std::to_string(rand()));
+
+  stdvec.push_back(bool(rand() % 2));
+  stdvec.push_back(rand());
+  stdvec.push_back(0.5f + rand());
+  stdvec.push_back("hello world" + std::to_string(rand()));
+
+  BENCHMARK("static vector bool subscript operator") {
+    return vec[0];
+  };
+  BENCHMARK("static vector int subscript operator") {
+    return vec[1];
+  };
+  BENCHMARK("static vector float subscript operator") {
+    return vec[2];
+  };
+  BENCHMARK("static vector std::string subscript operator") {
+    return vec[3];
+  };
+
+  BENCHMARK("dynamic vector bool subscript operator") {
+    return dvec[0];
+  };
+  BENCHMARK("dynamic vector int subscript operator") {
+    return dvec[1];
+  };
+  BENCHMARK("dynamic vector float subscript operator") {
+    return dvec[2];
+  };
+  BENCHMARK("dynamic vector std::string subscript operator") {
+    return dvec[3];
+  };
+
+  BENCHMARK("std::vector<std::variant> bool subscript operator") {
+    return stdvec[0];
+  };
+  BENCHMARK("std::vector<std::variant> int subscript operator") {
+    return stdvec[1];
+  };
+  BENCHMARK("std::vector<std::variant> float subscript operator") {
+    return stdvec[2];
+  };
+  BENCHMARK("std::vector<std::variant> std::string subscript operator") {
+    return stdvec[3];
+  };
+
+  BENCHMARK("static vector bool get") {
+    return vec.get<bool>(0);
+  };
+  BENCHMARK("static vector int get") {
+    return vec.get<int>(1);
+  };
+  BENCHMARK("static vector float get") {
+    return vec.get<float>(2);
+  };
+  BENCHMARK("static vector std::string get") {
+    return vec.get<std::string>(3);
+  };
+
+  BENCHMARK("dynamic vector bool get") {
+    return dvec.get<bool>(0);
+  };
+  BENCHMARK("dynamic vector int get") {
+    return dvec.get<int>(1);
+  };
+  BENCHMARK("dynamic vector float get") {
+    return dvec.get<float>(2);
+  };
+  BENCHMARK("dynamic vector std::string get") {
+    return dvec.get<std::string>(3);
+  };
+
+  BENCHMARK("std::vector<std::variant> bool std::get") {
+    return std::get<bool>(vec[0]);
+  };
+  BENCHMARK("std::vector<std::variant> int std::get") {
+    return std::get<int>(vec[1]);
   };
   BENCHMARK("std::vector<std::variant> float std::get") {
     return std::get<float>(vec[2]);
@@ -515,4 +2044,535 @@ TEST_CASE("performance", "varvec benchmarks") {
     return std::get<std::string>(vec[3]);
   };
 }
+
+TEST_CASE("offset storage performance", "varvec benchmarks") {
+  constexpr size_t members = 1 << 20;
+
+  std::unique_ptr<varvec::storage::offsets::virtual_offset_storage> virt =
+      std::make_unique<varvec::storage::offsets::concrete_offset_storage<uint32_t>>(members);
+  varvec::storage::offsets::dynamic_offset_storage devirt(members, sizeof(uint32_t));
+  for (size_t i = 0; i < members; ++i) {
+    virt->set(i, i);
+    devirt.set(i, i);
+  }
+
+  BENCHMARK("virtual offset storage scan") {
+    size_t sum = 0;
+    for (size_t i = 0; i < members; ++i) sum += virt->get(i);
+    return sum;
+  };
+  BENCHMARK("devirtualized offset storage scan") {
+    size_t sum = 0;
+    for (size_t i = 0; i < members; ++i) sum += devirt.get(i);
+    return sum;
+  };
+  BENCHMARK("devirtualized offset storage batch scan") {
+    return devirt.with_offsets([&] (auto const* offs) {
+      size_t sum = 0;
+      for (size_t i = 0; i < members; ++i) sum += offs[i];
+      return sum;
+    });
+  };
+
+  varvec::vector<int, double> vec;
+  for (size_t i = 0; i < members; ++i) {
+    if (i % 2) vec.push_back(static_cast<int>(i));
+    else vec.push_back(static_cast<double>(i));
+  }
+
+  BENCHMARK("dynamic vector visit scan") {
+    double sum = 0;
+    for (size_t i = 0; i < vec.size(); ++i) {
+      vec.visit(i, [&] (auto& val) noexcept { sum += val; });
+    }
+    return sum;
+  };
+}
+
+TEST_CASE("emplace performance", "varvec benchmarks") {
+  // Long enough to defeat the small string optimization.
+  std::string const payload(64, 'x');
+  using vector = varvec::vector<int, double, std::string>;
+
+  BENCHMARK("10K strings, push_back") {
+    vector vec;
+    for (int i = 0; i < 10'000; ++i) vec.push_back(std::string(payload.data(), payload.size()));
+    return vec.size();
+  };
+
+  BENCHMARK("10K strings, emplace_back") {
+    vector vec;
+    for (int i = 0; i < 10'000; ++i) vec.emplace_back<std::string>(payload.data(), payload.size());
+    return vec.size();
+  };
+
+  BENCHMARK("10K strings, variant push_back") {
+    vector vec;
+    for (int i = 0; i < 10'000; ++i) {
+      vec.push_back(vector::logical_type {std::in_place_type<std::string>, payload.data(), payload.size()});
+    }
+    return vec.size();
+  };
+
+  BENCHMARK("10K strings, std::vector<std::variant> emplace_back") {
+    std::vector<std::variant<int, double, std::string>> vec;
+    for (int i = 0; i < 10'000; ++i) {
+      vec.emplace_back(std::in_place_type<std::string>, payload.data(), payload.size());
+    }
+    return vec.size();
+  };
+}
+
+TEST_CASE("bulk append performance", "varvec benchmarks") {
+  using value = std::variant<bool, int, float, double>;
+  using vector = varvec::vector<bool, int, float, double>;
+
+  std::vector<value> values;
+  for (int i = 0; i < 100'000; ++i) {
+    switch (i % 4) {
+      case 0: values.emplace_back(true); break;
+      case 1: values.emplace_back(i); break;
+      case 2: values.emplace_back(i * 0.5f); break;
+      default: values.emplace_back(i * 0.25); break;
+    }
+  }
+  std::vector<int> ints(100'000, 1337);
+
+  BENCHMARK("100K variants, push_back loop") {
+    vector vec;
+    for (auto const& val : values) vec.push_back(val);
+    return vec.size();
+  };
+
+  BENCHMARK("100K variants, append_range") {
+    vector vec;
+    vec.append_range(values);
+    return vec.size();
+  };
+
+  BENCHMARK("100K ints, push_back loop") {
+    vector vec;
+    for (auto val : ints) vec.push_back(val);
+    return vec.size();
+  };
+
+  BENCHMARK("100K ints, append_range") {
+    vector vec;
+    vec.append_range(std::span {ints});
+    return vec.size();
+  };
+}
+
+TEST_CASE("type query performance", "varvec benchmarks") {
+  varvec::vector<bool, int, float, double> vec;
+  for (int i = 0; i < 1'000'000; ++i) {
+    if (i % 4 == 0) vec.push_back(i * 0.5);
+    else vec.push_back(i);
+  }
+
+  BENCHMARK("1M members, visit and count doubles") {
+    size_t count = 0;
+    for (size_t i = 0; i < vec.size(); ++i) {
+      vec.visit(i, [&] <class T> (T const&) { count += std::is_same_v<T, double>; });
+    }
+    return count;
+  };
+
+  BENCHMARK("1M members, count_of<double>") {
+    return vec.count_of<double>();
+  };
+
+  BENCHMARK("1M members, find_first<bool> (absent)") {
+    return vec.find_first<bool>();
+  };
+
+  BENCHMARK("1M members, positions_of<double>") {
+    return vec.positions_of<double>().size();
+  };
+}
+
+TEST_CASE("typed view performance", "varvec benchmarks") {
+  varvec::vector<bool, int, float, double> vec;
+  for (int i = 0; i < 1'000'000; ++i) {
+    if (i % 8 == 0) vec.push_back(i * 0.5f);
+    else vec.push_back(i);
+  }
+
+  BENCHMARK("1M members, sum floats via iterator and visit") {
+    float sum = 0;
+    for (auto val : vec) {
+      val.visit([&] <class T> (T const& val) { if constexpr (std::is_same_v<T, float>) sum += val; });
+    }
+    return sum;
+  };
+
+  BENCHMARK("1M members, sum floats via view_of<float>") {
+    float sum = 0;
+    for (auto val : vec.view_of<float>()) sum += val;
+    return sum;
+  };
+}
+
+TEST_CASE("visitation performance", "varvec benchmarks") {
+  varvec::vector<bool, int, float, double> vec;
+  for (int i = 0; i < 1'000'000; ++i) {
+    switch (i % 4) {
+      case 0: vec.push_back(i % 3 == 0); break;
+      case 1: vec.push_back(i); break;
+      case 2: vec.push_back(i * 0.5f); break;
+      default: vec.push_back(i * 0.25); break;
+    }
+  }
+  auto view = vec.view();
+
+  BENCHMARK("1M members, sum via iterator and std::visit on copies") {
+    double sum = 0;
+    for (auto val : vec) {
+      std::visit([&] (auto const& val) { sum += val; }, decltype(vec)::value_type {val});
+    }
+    return sum;
+  };
+
+  BENCHMARK("1M members, sum via visit(index)") {
+    double sum = 0;
+    for (size_t i = 0; i < vec.size(); ++i) vec.visit(i, [&] (auto const& val) { sum += val; });
+    return sum;
+  };
+
+  BENCHMARK("1M members, sum via visit_all") {
+    double sum = 0;
+    vec.visit_all([&] (auto const& val) { sum += val; });
+    return sum;
+  };
+
+  BENCHMARK("1M members, sum via view visit(index)") {
+    double sum = 0;
+    for (size_t i = 0; i < view.size(); ++i) view.visit(i, [&] (auto const& val) { sum += val; });
+    return sum;
+  };
+
+  BENCHMARK("1M members, sum via view visit_all") {
+    double sum = 0;
+    view.visit_all([&] (auto const& val) { sum += val; });
+    return sum;
+  };
+}
+
+TEST_CASE("grouped visitation performance", "varvec benchmarks") {
+  // Types are shuffled, so in order visitation can't predict the type switch.
+  uint32_t state = 42;
+  varvec::vector<bool, int, float, double> vec;
+  for (int i = 0; i < 1'000'000; ++i) {
+    state = state * 1664525 + 1013904223;
+    switch (state >> 30) {
+      case 0: vec.push_back(i % 3 == 0); break;
+      case 1: vec.push_back(i); break;
+      case 2: vec.push_back(i * 0.5f); break;
+      default: vec.push_back(i * 0.25); break;
+    }
+  }
+
+  BENCHMARK("1M shuffled members, sum via visit_all") {
+    double sum = 0;
+    vec.visit_all([&] (auto const& val) { sum += val; });
+    return sum;
+  };
+
+  BENCHMARK("1M shuffled members, sum via visit_grouped") {
+    double sum = 0;
+    vec.visit_grouped([&] (auto const& val) { sum += val; });
+    return sum;
+  };
+
+  BENCHMARK("1M shuffled members, sum via visit_batched") {
+    double sum = 0;
+    vec.visit_batched([&] (auto vals) { for (auto val : vals) sum += val; });
+    return sum;
+  };
+}
+
+// Sums a stream of randomly typed members through both dispatch strategies.
+template <size_t count>
+void dispatch_benchmarks() {
+  using variant = tagged_list_t<std::variant, count>;
+  constexpr size_t members = 1 << 20;
+
+  uint32_t state = 42;
+  std::vector<uint16_t> types(members);
+  std::vector<int64_t> data(members);
+  for (size_t i = 0; i < members; ++i) {
+    state = state * 1664525 + 1013904223;
+    types[i] = (state >> 8) % count;
+    data[i] = i;
+  }
+
+  auto sum_tags = [] <size_t tag> (tagged<tag> const* ptr) { return tag + ptr->value; };
+  BENCHMARK(std::to_string(count) + " types, comparison dispatch") {
+    size_t sum = 0;
+    for (size_t i = 0; i < members; ++i) {
+      sum += varvec::storage::get_typed_ptr_by_comparison(types[i],
+          reinterpret_cast<uint8_t const*>(&data[i]), varvec::meta::identity<variant> {}, sum_tags);
+    }
+    return sum;
+  };
+  BENCHMARK(std::to_string(count) + " types, table dispatch") {
+    size_t sum = 0;
+    for (size_t i = 0; i < members; ++i) {
+      sum += varvec::storage::get_typed_ptr_by_table(types[i],
+          reinterpret_cast<uint8_t const*>(&data[i]), varvec::meta::identity<variant> {}, sum_tags);
+    }
+    return sum;
+  };
+}
+
+TEST_CASE("dispatch performance", "varvec benchmarks") {
+  dispatch_benchmarks<2>();
+  dispatch_benchmarks<8>();
+  dispatch_benchmarks<16>();
+  dispatch_benchmarks<32>();
+  dispatch_benchmarks<128>();
+  dispatch_benchmarks<300>();
+}
+
+TEST_CASE("dispatch hint performance", "varvec benchmarks") {
+  // Identical shapes, int64_t declared last, but only the first list is hinted.
+  using hinted = varvec::vector<bool, short, int, float, double, int64_t>;
+  using unhinted = varvec::vector<bool, char, int, float, double, int64_t>;
+
+  auto fill = [] (auto& vec) {
+    uint32_t state = 42;
+    for (int i = 0; i < 1'000'000; ++i) {
+      state = state * 1664525 + 1013904223;
+      switch ((state >> 8) % 20) {
+        case 0: vec.push_back(i % 3 == 0); break;
+        case 1: vec.push_back(static_cast<int>(i)); break;
+        case 2: vec.push_back(i * 0.5f); break;
+        case 3: vec.push_back(i * 0.25); break;
+        default: vec.push_back(static_cast<int64_t>(i)); break;
+      }
+    }
+  };
+
+  hinted hot;
+  unhinted cold;
+  fill(hot);
+  fill(cold);
+
+  BENCHMARK("1M members, 80% int64_t, declaration order dispatch") {
+    double sum = 0;
+    cold.visit_all([&] (auto const& val) { sum += val; });
+    return sum;
+  };
+
+  BENCHMARK("1M members, 80% int64_t, hinted dispatch") {
+    double sum = 0;
+    hot.visit_all([&] (auto const& val) { sum += val; });
+    return sum;
+  };
+}
+
+TEST_CASE("parallel performance", "varvec benchmarks") {
+  uint32_t state = 42;
+  varvec::vector<bool, int, float, double> vec;
+  for (int i = 0; i < 10'000'000; ++i) {
+    state = state * 1664525 + 1013904223;
+    switch (state >> 30) {
+      case 0: vec.push_back(i % 3 == 0); break;
+      case 1: vec.push_back(i); break;
+      case 2: vec.push_back(i * 0.5f); break;
+      default: vec.push_back(i * 0.25); break;
+    }
+  }
+
+  auto to_double = [] (auto const& val) { return static_cast<double>(val); };
+  for (size_t threads = 1; threads <= varvec::parallel::default_thread_count(); threads *= 2) {
+    BENCHMARK("10M members, transform_reduce, " + std::to_string(threads) + " threads") {
+      return varvec::parallel::transform_reduce(vec, 0.0, std::plus {}, to_double, threads);
+    };
+  }
+}
+
+TEST_CASE("segmented vector performance", "varvec benchmarks") {
+  constexpr int members = 10'000'000;
+
+  BENCHMARK("10M appends, dynamic vector") {
+    varvec::vector<bool, int, double, std::string> vec;
+    for (int i = 0; i < members; ++i) {
+      if (i % 8) vec.push_back(i);
+      else vec.push_back(i * 0.5);
+    }
+    return vec.size();
+  };
+
+  BENCHMARK("10M appends, segmented vector") {
+    varvec::segmented_vector<1 << 15, 4096, bool, int, double, std::string> vec;
+    for (int i = 0; i < members; ++i) {
+      if (i % 8) vec.push_back(i);
+      else vec.push_back(i * 0.5);
+    }
+    return vec.size();
+  };
+}
+
+TEST_CASE("mapped growth performance", "varvec benchmarks") {
+  constexpr size_t members = 64'000'000;
+
+  // pmr vectors go through a memory resource, and so always grow by copying.
+  BENCHMARK("64M int64_t appends, copying growth") {
+    varvec::pmr::vector<int64_t, double> vec;
+    for (size_t i = 0; i < members; ++i) vec.push_back(static_cast<int64_t>(i));
+    return vec.size();
+  };
+
+  BENCHMARK("64M int64_t appends, remapping growth") {
+    varvec::vector<int64_t, double> vec;
+    for (size_t i = 0; i < members; ++i) vec.push_back(static_cast<int64_t>(i));
+    return vec.size();
+  };
+}
+
+TEST_CASE("range erase performance", "varvec benchmarks") {
+  varvec::vector<bool, int, double, std::string> vec;
+  for (int i = 0; i < 100'000; ++i) {
+    if (i % 16) vec.push_back(i);
+    else vec.push_back(std::to_string(i));
+  }
+
+  // Expire roughly 10% of the members.
+  auto expired = [] (int val) { return val % 10 == 0; };
+  BENCHMARK_ADVANCED("100K members, expire 10% with erase in a loop")(Catch::Benchmark::Chronometer meter) {
+    std::vector<decltype(vec)> copies(meter.runs(), vec);
+    meter.measure([&] (int run) {
+      auto& copy = copies[run];
+      for (size_t i = 0; i < copy.size();) {
+        if (copy[i].index() == 1 && expired(copy.get<int>(i))) copy.erase(i);
+        else ++i;
+      }
+      return copy.size();
+    });
+  };
+
+  BENCHMARK_ADVANCED("100K members, expire 10% with erase_if")(Catch::Benchmark::Chronometer meter) {
+    std::vector<decltype(vec)> copies(meter.runs(), vec);
+    meter.measure([&] (int run) {
+      return varvec::erase_if(copies[run], varvec::overload {
+        expired,
+        [] (auto const&) { return false; }
+      });
+    });
+  };
+}
+
+TEST_CASE("range insert performance", "varvec benchmarks") {
+  varvec::vector<bool, int, double, std::string> vec;
+  for (int i = 0; i < 100'000; ++i) {
+    if (i % 16) vec.push_back(i);
+    else vec.push_back(std::to_string(i));
+  }
+  std::vector<double> batch(1000, 0.5);
+
+  BENCHMARK_ADVANCED("100K members, insert 1K in the middle with insert in a loop")(Catch::Benchmark::Chronometer meter) {
+    std::vector<decltype(vec)> copies(meter.runs(), vec);
+    meter.measure([&] (int run) {
+      auto& copy = copies[run];
+      for (size_t i = 0; i < batch.size(); ++i) copy.insert(50'000 + i, batch[i]);
+      return copy.size();
+    });
+  };
+
+  BENCHMARK_ADVANCED("100K members, insert 1K in the middle with insert_range")(Catch::Benchmark::Chronometer meter) {
+    std::vector<decltype(vec)> copies(meter.runs(), vec);
+    meter.measure([&] (int run) {
+      copies[run].insert_range(50'000, batch);
+      return copies[run].size();
+    });
+  };
+}
+
+TEST_CASE("shift performance", "varvec benchmarks") {
+  varvec::vector<bool, int, double> trivial;
+  varvec::vector<bool, int, double, std::string> mixed;
+  for (int i = 0; i < 100'000; ++i) {
+    if (i % 2) {
+      trivial.push_back(i);
+      mixed.push_back(i);
+    } else {
+      trivial.push_back(i * 0.5);
+      if (i % 64) mixed.push_back(i * 0.5);
+      else mixed.push_back(std::to_string(i));
+    }
+  }
+
+  auto per_op = [] (auto const& vec, char const* name, auto&& op) {
+    BENCHMARK_ADVANCED(name)(Catch::Benchmark::Chronometer meter) {
+      std::vector<std::decay_t<decltype(vec)>> copies(meter.runs(), vec);
+      meter.measure([&] (int run) {
+        op(copies[run]);
+        return copies[run].size();
+      });
+    };
+  };
+
+  per_op(trivial, "100K trivial members, insert at front", [] (auto& v) { v.insert(0, 1); });
+  per_op(trivial, "100K trivial members, erase at front", [] (auto& v) { v.erase(0); });
+  per_op(mixed, "100K mixed members, insert at front", [] (auto& v) { v.insert(0, 1); });
+  per_op(mixed, "100K mixed members, erase at front", [] (auto& v) { v.erase(0); });
+}
+
+TEST_CASE("recycle performance", "varvec benchmarks") {
+  BENCHMARK("1K members, fresh vector per request") {
+    size_t total = 0;
+    for (int request = 0; request < 100; ++request) {
+      varvec::vector<bool, int, double, std::string> vec;
+      for (int i = 0; i < 1'000; ++i) vec.push_back(i);
+      total += vec.size();
+    }
+    return total;
+  };
+
+  BENCHMARK("1K members, one vector cleared per request") {
+    size_t total = 0;
+    varvec::vector<bool, int, double, std::string> vec;
+    for (int request = 0; request < 100; ++request) {
+      vec.clear();
+      for (int i = 0; i < 1'000; ++i) vec.push_back(i);
+      total += vec.size();
+    }
+    return total;
+  };
+}
+
+TEST_CASE("memory resource performance", "varvec benchmarks") {
+  constexpr size_t vectors = 1'000'000;
+
+  BENCHMARK("1M short vectors, global allocator") {
+    size_t total = 0;
+    for (size_t i = 0; i < vectors; ++i) {
+      varvec::vector<bool, int, float, double> vec(4);
+      vec.push_back(true);
+      vec.push_back(static_cast<int>(i));
+      vec.push_back(0.5f);
+      vec.push_back(3.14159);
+      total += vec.size();
+    }
+    return total;
+  };
+
+  BENCHMARK("1M short vectors, monotonic arena") {
+    size_t total = 0;
+    std::array<std::byte, 1 << 16> buffer;
+    std::pmr::monotonic_buffer_resource arena {buffer.data(), buffer.size()};
+    for (size_t i = 0; i < vectors; ++i) {
+      // Release the whole arena at once, rather than vector by vector.
+      if (i % 256 == 0) arena.release();
+      varvec::pmr::vector<bool, int, float, double> vec(4, &arena);
+      vec.push_back(true);
+      vec.push_back(static_cast<int>(i));
+      vec.push_back(0.5f);
+      vec.push_back(3.14159);
+      total += vec.size();
+    }
+    return total;
+  };
+}
 #endif
@@ -1,18 +1,41 @@
 #include <bit>
 #include <new>
+#include <span>
 #include <cmath>
 #include <array>
+#include <algorithm>
+#include <tuple>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
+#include <ranges>
 #include <climits>
 #include <cstring>
 #include <cassert>
+#include <utility>
 #include <variant>
+#include <optional>
 #include <iostream>
 #include <concepts>
 #include <stdexcept>
+#include <filesystem>
 #include <functional>
 #include <type_traits>
+#include <system_error>
+#include <memory_resource>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 namespace varvec::meta {
 
@@ -218,6 +241,322 @@ namespace varvec::meta {
 
 }
 
+namespace varvec::serialization {
+
+  inline constexpr std::array<char, 4> magic {'V', 'V', 'E', 'C'};
+  inline constexpr uint16_t current_version = 1;
+
+  // Fixed size header that precedes every serialized vector.
+  struct header {
+    std::array<char, 4> magic;
+    uint16_t version;
+    uint8_t little_endian;
+    uint8_t offset_width;
+    uint64_t signature;
+    uint64_t count;
+    uint64_t data_bytes;
+  };
+  static_assert(sizeof(header) == 32 && std::is_trivially_copyable_v<header>);
+
+  // Header of a file backing a storage::mapped_storage.
+  // The common header describes the live contents (data_bytes is the number of bytes
+  // in use), and is followed by the capacity the file is currently laid out for.
+  inline constexpr std::array<char, 4> mapped_magic {'V', 'V', 'M', 'F'};
+
+  struct mapped_header {
+    header common;
+    uint64_t members_capacity;
+    uint64_t bytes_capacity;
+  };
+  static_assert(sizeof(mapped_header) == 48 && std::is_trivially_copyable_v<mapped_header>);
+
+  // Computes the byte position of each region of a serialized vector, relative to
+  // the start of its header.
+  //
+  // Regions are laid out as [header | types | offsets | data], and each one starts on
+  // an 8 byte boundary, so that a suitably aligned buffer (a mapped file, for example)
+  // can be read in place.
+  struct layout {
+
+    static constexpr size_t region_alignment = alignof(uint64_t);
+
+    static constexpr size_t align(size_t pos) noexcept {
+      return (pos + region_alignment - 1) & ~(region_alignment - 1);
+    }
+
+    constexpr size_t types_begin() const noexcept {
+      return align(sizeof(header));
+    }
+
+    constexpr size_t offsets_begin() const noexcept {
+      return align(types_begin() + (count * type_bits + CHAR_BIT - 1) / CHAR_BIT);
+    }
+
+    constexpr size_t data_begin() const noexcept {
+      return align(offsets_begin() + count * offset_width);
+    }
+
+    constexpr size_t total_bytes() const noexcept {
+      return data_begin() + data_bytes;
+    }
+
+    size_t type_bits;
+    size_t offset_width;
+    size_t count;
+    size_t data_bytes;
+
+  };
+
+  constexpr uint64_t fnv1a(uint64_t hash, char const* str) noexcept {
+    while (*str) {
+      hash ^= static_cast<uint8_t>(*str++);
+      hash *= 0x100000001b3;
+    }
+    return hash;
+  }
+
+  constexpr uint64_t fnv1a(uint64_t hash, uint64_t val) noexcept {
+    for (size_t i = 0; i < sizeof(val); ++i) {
+      hash ^= (val >> (i * CHAR_BIT)) & 0xFF;
+      hash *= 0x100000001b3;
+    }
+    return hash;
+  }
+
+  // XXX: The name portion of this is compiler specific, so serialized vectors can only be
+  // exchanged between binaries built with the same toolchain. Sizes and alignments are
+  // mixed in as well so layout changes are caught regardless.
+  template <class T>
+  constexpr uint64_t type_signature() noexcept {
+    auto hash = fnv1a(0xcbf29ce484222325, __PRETTY_FUNCTION__);
+    hash = fnv1a(hash, sizeof(T));
+    return fnv1a(hash, alignof(T));
+  }
+
+  template <template <class...> class Variant, class... Types>
+  constexpr uint64_t compute_signature(meta::identity<Variant<Types...>>) noexcept {
+    auto hash = fnv1a(0xcbf29ce484222325, sizeof...(Types));
+    ((hash = fnv1a(hash, type_signature<Types>())), ...);
+    return hash;
+  }
+
+  // Signature of a given type list, used to reject data serialized with a different
+  // set of types.
+  template <class Variant>
+  constexpr uint64_t signature_v = compute_signature(meta::identity<Variant> {});
+
+  // Function validates the fields of a header that don't depend on the layout that follows it,
+  // throwing if it couldn't have been produced by a vector of the given types.
+  template <class Variant>
+  void check_header(header const& head, std::array<char, 4> const& expected_magic) {
+    if (head.magic != expected_magic) {
+      throw std::invalid_argument("varvec buffer does not contain a serialized vector");
+    } else if (head.version != current_version) {
+      throw std::invalid_argument("varvec buffer was serialized with an unsupported version: "
+          + std::to_string(head.version));
+    } else if (head.little_endian != (std::endian::native == std::endian::little)) {
+      throw std::invalid_argument("varvec buffer was serialized with a different endianness");
+    } else if (head.signature != signature_v<Variant>) {
+      throw std::invalid_argument("varvec buffer was serialized with a different type list");
+    }
+
+    auto const width = head.offset_width;
+    if (width != 1 && width != 2 && width != 4 && width != 8) {
+      throw std::invalid_argument("varvec buffer has an invalid offset width: " + std::to_string(width));
+    }
+  }
+
+  // Function reads and validates the header at the beginning of the given buffer,
+  // throwing if the buffer couldn't have been produced by a vector of the given types.
+  template <class Variant>
+  header read_header(std::span<std::byte const> bytes, size_t type_bits) {
+    header head;
+    if (bytes.size() < sizeof(head)) {
+      throw std::invalid_argument("varvec buffer is too small to contain a header");
+    }
+    memcpy(&head, bytes.data(), sizeof(head));
+    check_header<Variant>(head, magic);
+
+    auto const required = layout {type_bits, head.offset_width, head.count, head.data_bytes}.total_bytes();
+    if (bytes.size() < required) {
+      std::string msg = "varvec buffer was truncated. ";
+      msg += "Expected: " + std::to_string(required);
+      msg += ", size was: " + std::to_string(bytes.size());
+      throw std::invalid_argument(msg);
+    }
+    return head;
+  }
+
+}
+
+namespace varvec::storage {
+
+  // Default allocation policy for the dynamic storage types.
+#ifdef __linux__
+  // Buffers at least this large are mapped directly from the kernel instead of coming from
+  // operator new, so that they can be grown with mremap rather than copied.
+  // Matches the transparent huge page size on x86-64, which such buffers are advised to use.
+  inline constexpr size_t mapping_threshold = size_t {1} << 21;
+
+  // Smallest page size Linux runs with, so mappings are at least this well aligned.
+  inline constexpr size_t mapping_alignment = 4096;
+#endif
+
+  // Routes everything through global aligned new/delete, and is stateless so
+  // it costs nothing to carry around.
+  //
+  // On Linux, buffers above mapping_threshold are anonymous memory mappings instead.
+  // Whether a buffer is mapped is a pure function of its size and alignment, which
+  // byte_buffer always passes back, so no extra bookkeeping is needed.
+  struct default_allocator {
+    static uint8_t* allocate(size_t bytes, size_t alignment) {
+#ifdef __linux__
+      if (is_mapped(bytes, alignment)) {
+        auto* const ptr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) throw std::bad_alloc();
+        advise(ptr, bytes);
+        return static_cast<uint8_t*>(ptr);
+      }
+#endif
+      return static_cast<uint8_t*>(operator new[](bytes, std::align_val_t(alignment)));
+    }
+
+    static void deallocate(uint8_t* ptr, size_t bytes, size_t alignment) noexcept {
+#ifdef __linux__
+      if (is_mapped(bytes, alignment)) {
+        ::munmap(ptr, bytes);
+        return;
+      }
+#endif
+      operator delete[](ptr, std::align_val_t(alignment));
+    }
+
+#ifdef __linux__
+    // Function resizes a mapped buffer without copying it. The kernel either extends the
+    // mapping in place, or moves its pages to a new address, so the cost is page table
+    // updates rather than a copy of the contents.
+    // Returns nullptr if either size is below the threshold, or the remap fails, in which
+    // case the caller should fall back on allocating and copying.
+    static uint8_t* try_reallocate(uint8_t* ptr, size_t old_bytes, size_t new_bytes, size_t alignment) noexcept {
+      if (!is_mapped(old_bytes, alignment) || !is_mapped(new_bytes, alignment)) return nullptr;
+      auto* const remapped = ::mremap(ptr, old_bytes, new_bytes, MREMAP_MAYMOVE);
+      if (remapped == MAP_FAILED) return nullptr;
+      advise(remapped, new_bytes);
+      return static_cast<uint8_t*>(remapped);
+    }
+
+    static constexpr bool is_mapped(size_t bytes, size_t alignment) noexcept {
+      return bytes >= mapping_threshold && alignment <= mapping_alignment;
+    }
+
+    // Buffers this large are worth backing with huge pages. Purely a hint.
+    static void advise([[maybe_unused]] void* ptr, [[maybe_unused]] size_t bytes) noexcept {
+#ifdef MADV_HUGEPAGE
+      ::madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+    }
+#endif
+  };
+
+  // Allocation policy that routes everything through a polymorphic memory resource.
+  // Useful for placing vectors in an arena (std::pmr::monotonic_buffer_resource, etc),
+  // and then releasing them all at once.
+  struct resource_allocator {
+    resource_allocator() noexcept : resource(std::pmr::get_default_resource()) {}
+    resource_allocator(std::pmr::memory_resource* resource) noexcept : resource(resource) {}
+
+    uint8_t* allocate(size_t bytes, size_t alignment) const {
+      return static_cast<uint8_t*>(resource->allocate(bytes, alignment));
+    }
+
+    void deallocate(uint8_t* ptr, size_t bytes, size_t alignment) const noexcept {
+      resource->deallocate(ptr, bytes, alignment);
+    }
+
+    std::pmr::memory_resource* resource;
+  };
+
+  // Owning handle to an uninitialized block of bytes obtained from an allocation policy.
+  // Remembers its size because polymorphic resources need it for deallocation, which
+  // also lets the dynamic storage types drop their own size bookkeeping.
+  template <class Allocator, size_t alignment = alignof(std::max_align_t)>
+  struct byte_buffer {
+
+    explicit byte_buffer(size_t bytes, Allocator alloc = Allocator {}) :
+      alloc(alloc),
+      bytes(bytes),
+      ptr(this->alloc.allocate(bytes, alignment))
+    {}
+
+    byte_buffer(byte_buffer const&) = delete;
+
+    byte_buffer(byte_buffer&& other) noexcept :
+      alloc(other.alloc),
+      bytes(std::exchange(other.bytes, 0)),
+      ptr(std::exchange(other.ptr, nullptr))
+    {}
+
+    ~byte_buffer() noexcept {
+      if (ptr) alloc.deallocate(ptr, bytes, alignment);
+    }
+
+    byte_buffer& operator =(byte_buffer const&) = delete;
+
+    byte_buffer& operator =(byte_buffer&& other) noexcept {
+      if (this == &other) return *this;
+      this->~byte_buffer();
+      new(this) byte_buffer(std::move(other));
+      return *this;
+    }
+
+    uint8_t& operator [](size_t index) noexcept {
+      return ptr[index];
+    }
+
+    uint8_t const& operator [](size_t index) const noexcept {
+      return ptr[index];
+    }
+
+    uint8_t* get() noexcept {
+      return ptr;
+    }
+
+    uint8_t const* get() const noexcept {
+      return ptr;
+    }
+
+    size_t size() const noexcept {
+      return bytes;
+    }
+
+    Allocator get_allocator() const noexcept {
+      return alloc;
+    }
+
+    // Function resizes the buffer, preserving its first used bytes, which must be safe to
+    // relocate bitwise. Allocation policies that can resize a block without copying it
+    // (default_allocator, for mapped buffers) get the chance to do so first.
+    void resize(size_t new_bytes, size_t used) {
+      if constexpr (requires { alloc.try_reallocate(ptr, bytes, new_bytes, alignment); }) {
+        if (auto* const resized = alloc.try_reallocate(ptr, bytes, new_bytes, alignment)) {
+          ptr = resized;
+          bytes = new_bytes;
+          return;
+        }
+      }
+      byte_buffer tmp {new_bytes, alloc};
+      memcpy(tmp.get(), ptr, std::min(used, new_bytes));
+      *this = std::move(tmp);
+    }
+
+    [[no_unique_address]] Allocator alloc;
+    size_t bytes;
+    uint8_t* ptr;
+
+  };
+
+}
+
 namespace varvec::storage::offsets {
 
   // Virtual interface type for offset storage.
@@ -335,6 +674,177 @@ namespace varvec::storage::offsets {
 
   };
 
+  // Function computes the smallest offset width capable of representing the given offset.
+  constexpr size_t width_for(size_t offset) noexcept {
+    if (offset <= std::numeric_limits<uint8_t>::max()) {
+      return sizeof(uint8_t);
+    } else if (offset <= std::numeric_limits<uint16_t>::max()) {
+      return sizeof(uint16_t);
+    } else if (offset <= std::numeric_limits<uint32_t>::max()) {
+      return sizeof(uint32_t);
+    } else {
+      return sizeof(uint64_t);
+    }
+  }
+
+  // Function maps a runtime offset width onto the corresponding integer type.
+  template <class Func>
+  decltype(auto) dispatch_width(size_t width, Func&& callback) {
+    switch (width) {
+      case sizeof(uint8_t):
+        return std::forward<Func>(callback)(meta::identity<uint8_t> {});
+      case sizeof(uint16_t):
+        return std::forward<Func>(callback)(meta::identity<uint16_t> {});
+      case sizeof(uint32_t):
+        return std::forward<Func>(callback)(meta::identity<uint32_t> {});
+      default:
+        assert(width == sizeof(uint64_t));
+        return std::forward<Func>(callback)(meta::identity<uint64_t> {});
+    }
+  }
+
+  // Class implements the same runtime-width offset storage as concrete_offset_storage,
+  // but without the virtual interface.
+  //
+  // Every element access on a dynamic vector needs an offset lookup, and going through
+  // a vtable for that means none of our accessors can be inlined into the caller's loop.
+  // Instead, this class records the current width of its offsets as a runtime tag
+  // and switches on it. The switch is trivially predictable (the width changes at most
+  // three times over the lifetime of a vector), and is visible to the optimizer.
+  //
+  // Single element accessors dispatch on the width once per call, and batch operations
+  // should go through with_offsets, which dispatches once and hands the caller a typed
+  // pointer to the underlying array.
+  template <class Allocator>
+  struct basic_dynamic_offset_storage {
+
+    using size_type = size_t;
+    using buffer_type = byte_buffer<Allocator, alignof(uint64_t)>;
+
+    // XXX: Needs to be declared up front, as its return type is deduced
+    // and the rest of the class can't call it until it's been seen.
+    //
+    // Function dispatches on the current offset width a single time, and then
+    // invokes the given callback with a typed pointer to the underlying offsets.
+    template <class Func>
+    decltype(auto) with_offsets(Func&& callback) const {
+      return dispatch_width(width, [&] <class T> (meta::identity<T>) -> decltype(auto) {
+        return std::forward<Func>(callback)(reinterpret_cast<T const*>(storage.get()));
+      });
+    }
+
+    template <class Func>
+    decltype(auto) with_offsets(Func&& callback) {
+      return dispatch_width(width, [&] <class T> (meta::identity<T>) -> decltype(auto) {
+        return std::forward<Func>(callback)(reinterpret_cast<T*>(storage.get()));
+      });
+    }
+
+    explicit basic_dynamic_offset_storage(size_type members,
+        size_type width = sizeof(uint8_t), Allocator alloc = Allocator {}) :
+      width(width),
+      storage(members * width, alloc)
+    {
+      assert(width == 1 || width == 2 || width == 4 || width == 8);
+    }
+
+    basic_dynamic_offset_storage(basic_dynamic_offset_storage const& other) :
+      width(other.width),
+      storage(other.storage.size(), other.storage.get_allocator())
+    {
+      memcpy(storage.get(), other.storage.get(), storage.size());
+    }
+
+    basic_dynamic_offset_storage(basic_dynamic_offset_storage&&) noexcept = default;
+
+    ~basic_dynamic_offset_storage() = default;
+
+    basic_dynamic_offset_storage& operator =(basic_dynamic_offset_storage const& other) {
+      if (this == &other) return *this;
+      auto tmp {other};
+      *this = std::move(tmp);
+      return *this;
+    }
+
+    basic_dynamic_offset_storage& operator =(basic_dynamic_offset_storage&&) noexcept = default;
+
+    size_type operator [](size_type index) const noexcept {
+      assert(index < size());
+      return with_offsets([&] (auto const* offsets) -> size_type {
+        return offsets[index];
+      });
+    }
+
+    size_type get(size_type index) const noexcept {
+      return (*this)[index];
+    }
+
+    void set(size_type index, size_type offset) noexcept {
+      assert(index < capacity() && can_handle(offset));
+      with_offsets([&] <class T> (T* offsets) {
+        offsets[index] = static_cast<T>(offset);
+      });
+    }
+
+    // Function computes whether our current offset width can represent
+    // the given offset, or if the storage will have to be widened to do so.
+    bool can_handle(size_type offset) const noexcept {
+      if (width == sizeof(uint64_t)) return true;
+      return offset < (size_type {1} << (width * CHAR_BIT));
+    }
+
+    // Function widens the offset storage, in place, such that it can represent
+    // the given offset.
+    void realloc_for(size_type offset) {
+      reserve(size(), offset);
+    }
+
+    // Function grows the storage, in a single allocation, such that it can hold at least
+    // the given number of members, at a width that can represent the given offset.
+    // Never shrinks, or narrows.
+    void reserve(size_type members, size_type max_offset) {
+      auto const old_members = size();
+      auto const new_members = std::max(old_members, members);
+      auto const new_width = std::max(width, width_for(max_offset));
+      if (new_members == old_members && new_width == width) return;
+
+      buffer_type tmp {new_members * new_width, storage.get_allocator()};
+      with_offsets([&] (auto const* src) {
+        dispatch_width(new_width, [&] <class T> (meta::identity<T>) {
+          // Copy has to be done while we have full type information
+          // so the promotions are handled properly.
+          std::copy(src, src + old_members, reinterpret_cast<T*>(tmp.get()));
+        });
+      });
+      width = new_width;
+      storage = std::move(tmp);
+    }
+
+    void resize(size_type new_members) {
+      buffer_type tmp {new_members * width, storage.get_allocator()};
+      memcpy(tmp.get(), storage.get(), std::min(size(), new_members) * width);
+      storage = std::move(tmp);
+    }
+
+    size_type size() const noexcept {
+      return storage.size() / width;
+    }
+
+    size_type capacity() const noexcept {
+      return size();
+    }
+
+    size_type used_bytes() const noexcept {
+      return storage.size();
+    }
+
+    size_type width;
+    buffer_type storage;
+
+  };
+
+  using dynamic_offset_storage = basic_dynamic_offset_storage<default_allocator>;
+
 }
 
 namespace varvec::storage {
@@ -377,31 +887,108 @@ namespace varvec::storage {
     std::array<uint8_t, total_bytes> storage;
   };
 
+  template <class Allocator>
   struct dynamic_bitvec_storage {
-    explicit dynamic_bitvec_storage(size_t num_bytes) :
-      bytes(num_bytes),
-      storage(std::make_unique<uint8_t[]>(bytes))
-    {}
-    dynamic_bitvec_storage(dynamic_bitvec_storage const& other) : bytes(other.bytes), storage(nullptr) {
-      storage = std::make_unique<uint8_t[]>(bytes);
-      memcpy(storage.get(), other.storage.get(), bytes);
+    explicit dynamic_bitvec_storage(size_t num_bytes, Allocator alloc = Allocator {}) :
+      storage(num_bytes, alloc)
+    {
+      memset(storage.get(), 0, size());
+    }
+    dynamic_bitvec_storage(dynamic_bitvec_storage const& other) :
+      storage(other.size(), other.storage.get_allocator())
+    {
+      memcpy(storage.get(), other.storage.get(), size());
     }
     dynamic_bitvec_storage(dynamic_bitvec_storage&&) = default;
     ~dynamic_bitvec_storage() = default;
 
     void resize(size_t new_size) {
+      auto const old_size = size();
+      storage.resize(new_size, old_size);
+      if (new_size > old_size) memset(storage.get() + old_size, 0, new_size - old_size);
+    }
+
+    size_t size() const noexcept {
+      return storage.size();
+    }
+
+    byte_buffer<Allocator> storage;
+  };
+
+  // Bit vector storage that lives inline until it's asked to grow beyond its
+  // inline capacity, at which point it migrates to the heap.
+  //
+  // storage always points at whichever buffer is currently active, so the bitvec_api
+  // doesn't need to know which one it's talking to.
+  template <size_t inline_bytes>
+  struct small_bitvec_storage {
+    small_bitvec_storage() noexcept :
+      bytes(inline_bytes),
+      heap(nullptr),
+      buffer({0}),
+      storage(buffer.data())
+    {}
+    small_bitvec_storage(small_bitvec_storage const& other) :
+      bytes(other.bytes),
+      heap(nullptr),
+      buffer(other.buffer),
+      storage(buffer.data())
+    {
+      if (other.spilled()) {
+        heap = std::make_unique<uint8_t[]>(bytes);
+        memcpy(heap.get(), other.heap.get(), bytes);
+        storage = heap.get();
+      }
+    }
+    small_bitvec_storage(small_bitvec_storage&& other) noexcept :
+      bytes(other.bytes),
+      heap(std::move(other.heap)),
+      buffer(other.buffer),
+      storage(heap ? heap.get() : buffer.data())
+    {
+      other.bytes = inline_bytes;
+      other.storage = other.buffer.data();
+    }
+    ~small_bitvec_storage() = default;
+
+    void resize(size_t new_size) {
+      // Never migrate back inline, we'll just keep the allocation.
+      if (new_size <= inline_bytes && !spilled()) return;
+
       auto tmp = std::make_unique<uint8_t[]>(new_size);
-      memcpy(tmp.get(), storage.get(), std::min(size(), new_size));
+      memcpy(tmp.get(), storage, std::min(size(), new_size));
       bytes = new_size;
-      storage = std::move(tmp);
+      heap = std::move(tmp);
+      storage = heap.get();
+    }
+
+    size_t size() const noexcept {
+      return bytes;
+    }
+
+    bool spilled() const noexcept {
+      return heap != nullptr;
     }
 
+    size_t bytes;
+    std::unique_ptr<uint8_t[]> heap;
+    std::array<uint8_t, inline_bytes> buffer;
+    uint8_t* storage;
+  };
+
+  // Non-owning bit vector storage over a region of memory managed by someone else.
+  struct bitvec_view_storage {
+    bitvec_view_storage() noexcept : bytes(0), storage(nullptr) {}
+    bitvec_view_storage(size_t bytes, uint8_t* storage) noexcept : bytes(bytes), storage(storage) {}
+    bitvec_view_storage(bitvec_view_storage const&) = default;
+    ~bitvec_view_storage() = default;
+
     size_t size() const noexcept {
       return bytes;
     }
 
     size_t bytes;
-    std::unique_ptr<uint8_t[]> storage;
+    uint8_t* storage;
   };
 
   template <size_t bits_per_entry, class StorageBase>
@@ -426,11 +1013,17 @@ namespace varvec::storage {
     };
 
     bitvec_api() = default;
-    explicit bitvec_api(size_t total_bytes) : StorageBase(total_bytes) {}
+    template <class... Args>
+    explicit bitvec_api(size_t total_bytes, Args&&... args) :
+      StorageBase(total_bytes, std::forward<Args>(args)...)
+    {}
     bitvec_api(bitvec_api const&) = default;
     bitvec_api(bitvec_api&&) = default;
     ~bitvec_api() = default;
 
+    bitvec_api& operator =(bitvec_api const&) = default;
+    bitvec_api& operator =(bitvec_api&&) = default;
+
     static constexpr bool bpe = bits_per_entry;
     static_assert(bpe == 1 || bpe == 2 || bpe == 4 || bpe == 8,
         "varvec bit vectors can only encode representations of up to 1 byte, "
@@ -465,6 +1058,79 @@ namespace varvec::storage {
       return (this->size() * CHAR_BIT) / bits_per_entry;
     }
 
+    // Raw access to the packed representation.
+    uint8_t* data() noexcept {
+      return &this->storage[0];
+    }
+
+    uint8_t const* data() const noexcept {
+      return &this->storage[0];
+    }
+
+    // Function computes how many bytes of packed representation are occupied
+    // by the given number of entries.
+    static constexpr size_t bytes_for(size_t members) noexcept {
+      return (members * bits_per_entry + CHAR_BIT - 1) / CHAR_BIT;
+    }
+
+    // Function counts how many of the first `members` entries are equal to val.
+    size_t count(uint8_t val, size_t members) const noexcept {
+      size_t matches = 0;
+      scan(val, 0, members, [&] (size_t, uint64_t mask) {
+        matches += count_bits(mask);
+        return false;
+      });
+      return matches;
+    }
+
+    // Function finds the first entry in [from, members) that is equal to val,
+    // returning members if there isn't one.
+    size_t find(uint8_t val, size_t from, size_t members) const noexcept {
+      size_t found = members;
+      scan(val, from, members, [&] (size_t word, uint64_t mask) {
+        found = entry_of(word, std::countr_zero(mask));
+        return true;
+      });
+      return found;
+    }
+
+    // Function invokes the callback with the index of every one of the first `members`
+    // entries that is equal to val, in order.
+    template <class Func>
+    void for_each_match(uint8_t val, size_t members, Func&& callback) const {
+      scan(val, 0, members, [&] (size_t word, uint64_t mask) {
+        while (mask) {
+          callback(entry_of(word, std::countr_zero(mask)));
+          mask &= mask - 1;
+        }
+        return false;
+      });
+    }
+
+    // Function invokes the callback with the index and value of every entry in [from, to), in order.
+    // Entries are decoded out of a register, so the storage is only read once per word.
+    template <class Func>
+    void for_each_entry(size_t from, size_t to, Func&& callback) const {
+      constexpr size_t per_word = 64 / bits_per_entry;
+      constexpr uint64_t field = ~(~uint64_t {0} << bits_per_entry);
+
+      auto const* const bytes = data();
+      while (from < to) {
+        auto const word = from / per_word;
+        auto const last = std::min(to, (word + 1) * per_word);
+
+        // Only the last word can be partial, and reading past it could leave the buffer.
+        auto const* const ptr = bytes + word * sizeof(uint64_t);
+        auto const avail = bytes_for(last) - word * sizeof(uint64_t);
+        auto entries = avail == sizeof(uint64_t) ? load_word(ptr) : load_word(ptr, avail);
+        entries >>= (from % per_word) * bits_per_entry;
+
+        for (; from < last; ++from, entries >>= bits_per_entry) {
+          callback(from, static_cast<uint8_t>(entries & field));
+        }
+      }
+    }
+
     std::tuple<size_t, size_t> calculate_location(size_t index) const noexcept {
       // Divide by 8 to get the byte index, then mod by 8 to get the bit index.
       // Implemented as a shift and a mask for speed
@@ -472,20 +1138,140 @@ namespace varvec::storage {
       return {bit_idx >> 3, bit_idx & 7};
     }
 
-  };
+    private:
 
-  template <size_t bits_per_entry, size_t memcount>
-  struct static_bitvec :
-    bitvec_api<
-      bits_per_entry,
-      static_bitvec_storage<meta::int_ceil((bits_per_entry * memcount) / CHAR_BIT)>
-    >
-  {
+      // Bulk scans compare 64 bits worth of entries at a time, using the classic
+      // SWAR zero-field trick generalized to any field width: after XORing with the needle
+      // repeated across the word, matching entries are exactly the all zero fields.
+      // The top bit of every matching field is set in the resulting mask.
+      //
+      // When the target supports it, several words are processed per iteration using
+      // the same arithmetic in vector registers. The adds can't carry between fields,
+      // so lane widths don't matter.
+#if defined(__AVX2__)
+      static constexpr size_t words_per_block = 4;
+#elif defined(__SSE2__)
+      static constexpr size_t words_per_block = 2;
+#else
+      static constexpr size_t words_per_block = 1;
+#endif
+
+      static constexpr uint64_t repeat(uint64_t field) noexcept {
+        uint64_t word = 0;
+        for (size_t bit = 0; bit < 64; bit += bits_per_entry) word |= field << bit;
+        return word;
+      }
 
-    // Unfortunate to have to repeat this, but the language doesn't leave us many options
-    using parent_class = bitvec_api<
-        bits_per_entry,
-        static_bitvec_storage<meta::int_ceil((bits_per_entry * memcount) / CHAR_BIT)>
+      static constexpr uint64_t high_bits = repeat(uint64_t {1} << (bits_per_entry - 1));
+      static constexpr uint64_t low_bits = ~high_bits;
+
+      static constexpr size_t entry_of(size_t word, size_t bit) noexcept {
+        return (word * 64 + bit) / bits_per_entry;
+      }
+
+      static uint64_t load_word(uint8_t const* ptr, size_t bytes = sizeof(uint64_t)) noexcept {
+        uint64_t word = 0;
+        memcpy(&word, ptr, bytes);
+        if constexpr (std::endian::native == std::endian::big) word = __builtin_bswap64(word);
+        return word;
+      }
+
+      // Without a popcnt instruction std::popcount becomes a library call,
+      // which costs more than the rest of the scan put together.
+      static constexpr size_t count_bits(uint64_t word) noexcept {
+#if defined(__POPCNT__)
+        return std::popcount(word);
+#else
+        word = word - ((word >> 1) & 0x5555555555555555);
+        word = (word & 0x3333333333333333) + ((word >> 2) & 0x3333333333333333);
+        word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0F;
+        return (word * 0x0101010101010101) >> 56;
+#endif
+      }
+
+      static uint64_t match_word(uint64_t word, uint64_t pattern) noexcept {
+        auto const x = word ^ pattern;
+        return ~(((x & low_bits) + low_bits) | x) & high_bits;
+      }
+
+      static void match_block(uint8_t const* ptr, uint64_t pattern, uint64_t (&masks)[words_per_block]) noexcept {
+#if defined(__AVX2__)
+        auto const low = _mm256_set1_epi64x(low_bits);
+        auto const x = _mm256_xor_si256(
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(ptr)), _mm256_set1_epi64x(pattern));
+        auto const t = _mm256_or_si256(_mm256_add_epi8(_mm256_and_si256(x, low), low), x);
+        auto const m = _mm256_andnot_si256(t, _mm256_set1_epi64x(high_bits));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(masks), m);
+#elif defined(__SSE2__)
+        auto const low = _mm_set1_epi64x(low_bits);
+        auto const x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(ptr)), _mm_set1_epi64x(pattern));
+        auto const t = _mm_or_si128(_mm_add_epi8(_mm_and_si128(x, low), low), x);
+        auto const m = _mm_andnot_si128(t, _mm_set1_epi64x(high_bits));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(masks), m);
+#else
+        masks[0] = match_word(load_word(ptr), pattern);
+#endif
+      }
+
+      // Function walks the match masks for entries [from, members), a word at a time,
+      // skipping words without matches. Stops early if the callback returns true.
+      template <class Func>
+      void scan(uint8_t val, size_t from, size_t members, Func&& callback) const {
+        if (from >= members) return;
+        assert(val < (1 << bits_per_entry));
+
+        auto const* const bytes = data();
+        auto const pattern = val * repeat(1);
+        auto const end_bit = members * bits_per_entry;
+        auto const full_words = end_bit / 64;
+
+        size_t word = (from * bits_per_entry) / 64;
+        auto const first_word = word;
+
+        // Match bits below the starting entry are masked out of the first word.
+        auto const lead_mask = ~uint64_t {0} << ((from * bits_per_entry) % 64);
+        if (lead_mask != ~uint64_t {0} && word < full_words) {
+          auto const mask = match_word(load_word(bytes + word * sizeof(uint64_t)), pattern) & lead_mask;
+          if (mask && callback(word, mask)) return;
+          ++word;
+        }
+
+        for (; word + words_per_block <= full_words; word += words_per_block) {
+          uint64_t masks[words_per_block];
+          match_block(bytes + word * sizeof(uint64_t), pattern, masks);
+          for (size_t i = 0; i < words_per_block; ++i) {
+            if (masks[i] && callback(word + i, masks[i])) return;
+          }
+        }
+        for (; word < full_words; ++word) {
+          auto const mask = match_word(load_word(bytes + word * sizeof(uint64_t)), pattern);
+          if (mask && callback(word, mask)) return;
+        }
+
+        // Partial last word. Entries past the end are zeroed, so they have to be masked off.
+        if (auto const tail_bits = end_bit % 64) {
+          auto const tail_bytes = (tail_bits + CHAR_BIT - 1) / CHAR_BIT;
+          auto const tail = load_word(bytes + word * sizeof(uint64_t), tail_bytes);
+          auto mask = match_word(tail, pattern) & ((uint64_t {1} << tail_bits) - 1);
+          if (word == first_word) mask &= lead_mask;
+          if (mask) callback(word, mask);
+        }
+      }
+
+  };
+
+  template <size_t bits_per_entry, size_t memcount>
+  struct static_bitvec :
+    bitvec_api<
+      bits_per_entry,
+      static_bitvec_storage<meta::int_ceil((bits_per_entry * memcount) / CHAR_BIT)>
+    >
+  {
+
+    // Unfortunate to have to repeat this, but the language doesn't leave us many options
+    using parent_class = bitvec_api<
+        bits_per_entry,
+        static_bitvec_storage<meta::int_ceil((bits_per_entry * memcount) / CHAR_BIT)>
     >;
 
     static_bitvec() noexcept : parent_class() {}
@@ -497,21 +1283,49 @@ namespace varvec::storage {
 
   };
 
-  template <size_t bits_per_entry>
-  struct dynamic_bitvec : bitvec_api<bits_per_entry, dynamic_bitvec_storage> {
+  template <size_t bits_per_entry, class Allocator = default_allocator>
+  struct dynamic_bitvec : bitvec_api<bits_per_entry, dynamic_bitvec_storage<Allocator>> {
 
-    using parent_class = bitvec_api<bits_per_entry, dynamic_bitvec_storage>;
+    using parent_class = bitvec_api<bits_per_entry, dynamic_bitvec_storage<Allocator>>;
 
     static constexpr size_t init_size = 8;
 
-    dynamic_bitvec() : parent_class((init_size * bits_per_entry) / CHAR_BIT) {}
-    explicit dynamic_bitvec(size_t members) : parent_class((members * bits_per_entry) / CHAR_BIT) {}
+    dynamic_bitvec() : parent_class(parent_class::bytes_for(init_size)) {}
+    explicit dynamic_bitvec(size_t members, Allocator alloc = Allocator {}) :
+      parent_class(parent_class::bytes_for(members), alloc)
+    {}
     dynamic_bitvec(dynamic_bitvec const&) = default;
     dynamic_bitvec(dynamic_bitvec&&) = default;
     ~dynamic_bitvec() = default;
 
     using parent_class::operator [];
 
+    void resize(size_t members) {
+      parent_class::resize(parent_class::bytes_for(members));
+    }
+
+  };
+
+  template <size_t bits_per_entry, size_t memcount>
+  struct small_bitvec :
+    bitvec_api<
+      bits_per_entry,
+      small_bitvec_storage<(bits_per_entry * memcount + CHAR_BIT - 1) / CHAR_BIT>
+    >
+  {
+
+    using parent_class = bitvec_api<
+        bits_per_entry,
+        small_bitvec_storage<(bits_per_entry * memcount + CHAR_BIT - 1) / CHAR_BIT>
+    >;
+
+    small_bitvec() noexcept : parent_class() {}
+    small_bitvec(small_bitvec const&) = default;
+    small_bitvec(small_bitvec&&) = default;
+    ~small_bitvec() = default;
+
+    using parent_class::operator [];
+
     void resize(size_t members) {
       parent_class::resize(meta::int_ceil((members * bits_per_entry) / (double) CHAR_BIT));
     }
@@ -587,29 +1401,38 @@ namespace varvec::storage {
     return realign_backwards_for(ptr, align_info[type].align_of);
   }
 
-  // Given a type index, an object base pointer, a list of variant types, and a generic callback,
-  // function implements a std::visit-esque interface where it unwraps and types the underlying
-  // packed object storage, passing through a pointer to the callback function.
-  // The passed pointer is NOT guaranteed to be well aligned for the given type.
+  // Type lists longer than this are dispatched through a table of function pointers instead of a
+  // chain of comparisons. The chain lets the compiler inline the callback into every branch, which
+  // wins for short lists, but its cost grows linearly with the position of the active type, while
+  // the table costs one indirect call regardless of how many types there are.
+  inline constexpr size_t dispatch_table_threshold = 16;
+
+  template <class Storage, class T>
+  using typed_ptr_t = std::conditional_t<std::is_const_v<Storage>, T const, T>*;
+
+  template <class T, class Result, class Storage, class Func>
+  constexpr Result typed_ptr_thunk(Storage* curr_data, Func&& callback) {
+    return std::forward<Func>(callback)(reinterpret_cast<typed_ptr_t<Storage, T>>(curr_data));
+  }
+
+  template <class Result, class Storage, class Func, class... Types>
+  constexpr std::array<Result (*) (Storage*, Func&&), sizeof...(Types)> typed_ptr_table_v {
+    &typed_ptr_thunk<Types, Result, Storage, Func>...
+  };
+
+  // Dispatches a type index by comparing it against each index in turn.
   template <class Storage,
            template <class...> class Variant, meta::storable... Types, class Func>
-  constexpr decltype(auto) get_typed_ptr_for(uint8_t curr_type,
+  constexpr decltype(auto) get_typed_ptr_by_comparison(size_t curr_type,
       Storage* curr_data, meta::identity<Variant<Types...>>, Func&& callback)
     noexcept(meta::nothrow_visitor_v<Func, Types...>)
   {
     // Lol. Not sure this is better than the old way
     auto recurse = [&] <class T, class... Ts, class Cont, size_t idx, size_t... idxs>
       (Cont&& cont, std::index_sequence<idx, idxs...>) -> decltype(auto) {
-      // Forward const
-      using ptr_type = std::conditional_t<
-        std::is_const_v<Storage>,
-        T const,
-        T
-      >;
-
       // If this is the index for our type, cast the pointer into the proper type and call the callback.
       if (idx == curr_type) {
-        return std::forward<Func>(callback)(reinterpret_cast<ptr_type*>(curr_data));
+        return std::forward<Func>(callback)(reinterpret_cast<typed_ptr_t<Storage, T>>(curr_data));
       }
 
       // Otherwise recurse.
@@ -625,6 +1448,128 @@ namespace varvec::storage {
     return recurse.template operator ()<Types...>(recurse, std::index_sequence_for<Types...> {});
   }
 
+  // Dispatches a type index with a single indirect call through a compile-time generated table.
+  template <class Storage,
+           template <class...> class Variant, meta::storable... Types, class Func>
+  constexpr decltype(auto) get_typed_ptr_by_table(size_t curr_type,
+      Storage* curr_data, meta::identity<Variant<Types...>>, Func&& callback)
+    noexcept(meta::nothrow_visitor_v<Func, Types...>)
+  {
+    // Like std::visit, every alternative has to produce the same type.
+    using first_type = std::tuple_element_t<0, std::tuple<Types...>>;
+    using result_type = std::invoke_result_t<Func, typed_ptr_t<Storage, first_type>>;
+
+    auto& table = typed_ptr_table_v<result_type, Storage, Func, Types...>;
+    assert(curr_type < table.size());
+    return table[curr_type](curr_data, std::forward<Func>(callback));
+  }
+
+  // Base for dispatch_hint specializations.
+  // Hot types are checked first, in the order given, on a branch marked [[likely]], before
+  // falling back to the usual dispatch. This only changes the order in which type indices are
+  // tested, so stored type indices, and therefore layouts and serialized buffers, are unaffected.
+  // If profiled is set, every dispatch for the type list is counted (see dispatch_counts).
+  template <bool profiled, class... Hot>
+  struct dispatch_policy {
+    static constexpr bool profile = profiled;
+  };
+
+  // Opt-in customization point, keyed on the logical variant type, for type lists whose members
+  // are heavily skewed towards a few types. For example:
+  //
+  //   template <>
+  //   struct varvec::storage::dispatch_hint<std::variant<bool, int64_t, double, std::string>> :
+  //     varvec::storage::dispatch_policy<false, int64_t, double>
+  //   {};
+  //
+  // The specialization applies to every vector and view over that type list.
+  template <class Variant>
+  struct dispatch_hint : dispatch_policy<false> {};
+
+  template <class Variant>
+  inline std::array<std::atomic<size_t>, meta::num_types_in(meta::identity<Variant> {})> dispatch_counters_v {};
+
+  // Returns a snapshot of how many times each type index has been dispatched for a profiled
+  // type list. Counts include the vector's own internal dispatches (copies, moves, destruction),
+  // not just user visitation.
+  template <class Variant>
+  std::array<size_t, meta::num_types_in(meta::identity<Variant> {})> dispatch_counts() noexcept {
+    static_assert(dispatch_hint<Variant>::profile, "Type list is not profiled");
+    std::array<size_t, meta::num_types_in(meta::identity<Variant> {})> counts;
+    for (size_t i = 0; i < counts.size(); ++i) {
+      counts[i] = dispatch_counters_v<Variant>[i].load(std::memory_order_relaxed);
+    }
+    return counts;
+  }
+
+  template <class Variant>
+  void reset_dispatch_counts() noexcept {
+    static_assert(dispatch_hint<Variant>::profile, "Type list is not profiled");
+    for (auto& counter : dispatch_counters_v<Variant>) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // Dispatches a type index using whichever strategy suits the length of the type list.
+  template <class Storage,
+           template <class...> class Variant, meta::storable... Types, class Func>
+  constexpr decltype(auto) get_typed_ptr_by_length(size_t curr_type,
+      Storage* curr_data, meta::identity<Variant<Types...>> variant, Func&& callback)
+    noexcept(meta::nothrow_visitor_v<Func, Types...>)
+  {
+    if constexpr (sizeof...(Types) > dispatch_table_threshold) {
+      return get_typed_ptr_by_table(curr_type, curr_data, variant, std::forward<Func>(callback));
+    } else {
+      return get_typed_ptr_by_comparison(curr_type, curr_data, variant, std::forward<Func>(callback));
+    }
+  }
+
+  // Tests the hot types of a dispatch_policy before falling back on get_typed_ptr_by_length.
+  template <bool profiled, class... Hot, class Storage,
+           template <class...> class Variant, meta::storable... Types, class Func>
+  constexpr decltype(auto) get_typed_ptr_by_hint(dispatch_policy<profiled, Hot...>, size_t curr_type,
+      Storage* curr_data, meta::identity<Variant<Types...>> variant, Func&& callback)
+    noexcept(meta::nothrow_visitor_v<Func, Types...>)
+  {
+    constexpr auto listed = [] <class T> () { return (std::is_same_v<T, Types> || ...); };
+    static_assert((listed.template operator ()<Hot>() && ...), "Hot types must appear in the type list");
+
+    auto recurse = [&] <class T, class... Ts, class Cont> (Cont&& cont) -> decltype(auto) {
+      if (curr_type == meta::index_of_v<T, Types...>) [[likely]] {
+        return std::forward<Func>(callback)(reinterpret_cast<typed_ptr_t<Storage, T>>(curr_data));
+      }
+
+      if constexpr (sizeof...(Ts)) {
+        return cont.template operator ()<Ts...>(cont);
+      } else {
+        return get_typed_ptr_by_length(curr_type, curr_data, variant, std::forward<Func>(callback));
+      }
+    };
+
+    if constexpr (sizeof...(Hot)) {
+      return recurse.template operator ()<Hot...>(recurse);
+    } else {
+      return get_typed_ptr_by_length(curr_type, curr_data, variant, std::forward<Func>(callback));
+    }
+  }
+
+  // Given a type index, an object base pointer, a list of variant types, and a generic callback,
+  // function implements a std::visit-esque interface where it unwraps and types the underlying
+  // packed object storage, passing through a pointer to the callback function.
+  // The passed pointer is NOT guaranteed to be well aligned for the given type.
+  template <class Storage,
+           template <class...> class Variant, meta::storable... Types, class Func>
+  constexpr decltype(auto) get_typed_ptr_for(size_t curr_type,
+      Storage* curr_data, meta::identity<Variant<Types...>> variant, Func&& callback)
+    noexcept(meta::nothrow_visitor_v<Func, Types...>)
+  {
+    using hint = dispatch_hint<Variant<Types...>>;
+    if constexpr (hint::profile) {
+      dispatch_counters_v<Variant<Types...>>[curr_type].fetch_add(1, std::memory_order_relaxed);
+    }
+    return get_typed_ptr_by_hint(hint {}, curr_type, curr_data, variant, std::forward<Func>(callback));
+  }
+
 
   // Given a type index, an object base pointer, a list of variant types, and a generic callback,
   // function implements a std::visit-esque interface where it unwraps and types the underlying
@@ -632,7 +1577,7 @@ namespace varvec::storage {
   // The passed pointer IS guaranteed to be well aligned for the given type.
   template <class Storage,
            template <class...> class Variant, meta::storable... Types, class Func>
-  constexpr decltype(auto) get_aligned_ptr_for(uint8_t curr_type,
+  constexpr decltype(auto) get_aligned_ptr_for(size_t curr_type,
       Storage* curr_data, meta::identity<Variant<Types...>> variant, Func&& callback)
     noexcept(meta::nothrow_visitor_v<Func, Types...>)
   {
@@ -868,6 +1813,23 @@ namespace varvec::storage {
       offset += count;
     }
 
+    template <class Func>
+    decltype(auto) with_offsets(Func&& callback) const {
+      return std::forward<Func>(callback)(offsets.data());
+    }
+
+    template <class Func>
+    decltype(auto) with_offsets(Func&& callback) {
+      return std::forward<Func>(callback)(offsets.data());
+    }
+
+    // Static storage can't grow, so reserving is just a capacity check.
+    void reserve(size_type members, size_type more_bytes) const {
+      if (members > memcount || more_bytes > bytes) {
+        throw std::bad_alloc();
+      }
+    }
+
     uint8_t* resize(size_type) noexcept {
       // XXX: Not sure if this is the right move.
       // I was originally throwing std::bad_alloc here, which seems like a nicer solution.
@@ -968,11 +1930,13 @@ namespace varvec::storage {
   };
 
   // Base class for dynamically sized buffer storage.
-  template <class Variant>
-  struct dynamic_storage {
+  // All allocations (data, types, and offsets) are routed through the given allocation policy.
+  template <class Variant, class Allocator>
+  struct basic_dynamic_storage {
 
     using size_type = size_t;
     using variant_type = Variant;
+    using allocator_type = Allocator;
 
     static constexpr auto start_members = 8;
     static constexpr auto start_size = start_members * meta::mean_size_of(meta::identity<variant_type> {});
@@ -994,79 +1958,79 @@ namespace varvec::storage {
     // Otherwise fall back on std::vector.
     using type_storage = std::conditional_t<
       type_bits <= 8,
-      dynamic_bitvec<type_bits>,
+      dynamic_bitvec<type_bits, Allocator>,
       unpacked_type_storage
     >;
 
-    // Interface type with which to access rebuildable offset storage.
-    using offset_storage = std::unique_ptr<offsets::virtual_offset_storage>;
+    // Runtime-width offset storage, rebuilt as the offsets grow.
+    using offset_storage = offsets::basic_dynamic_offset_storage<Allocator>;
 
     // Make the optimistic choice that the user will store smaller things,
     // will rebuild if wrong
-    using initial_offset_storage = offsets::concrete_offset_storage<
+    static constexpr size_type initial_offset_width = sizeof(
       meta::smallest_type_for_t<meta::min_size_of(meta::identity<variant_type> {})>
-    >;
+    );
 
-    using deleter = aligned_deleter<uint8_t, std::align_val_t(max_alignment)>;
+    using data_storage = byte_buffer<Allocator, max_alignment>;
 
-    using data_storage = std::unique_ptr<uint8_t[], deleter>;
+    explicit basic_dynamic_storage(Allocator alloc = Allocator {}) :
+      basic_dynamic_storage(start_members, start_size, alloc)
+    {}
 
-    dynamic_storage() :
-      bytes(start_size),
-      count(0),
-      offset(0),
-      types(start_members),
-      offsets(std::make_unique<initial_offset_storage>(start_members)),
-      data(new(std::align_val_t(max_alignment)) uint8_t[bytes])
+    explicit basic_dynamic_storage(size_type members, Allocator alloc = Allocator {}) :
+      basic_dynamic_storage(members, members * meta::mean_size_of(meta::identity<variant_type> {}), alloc)
     {}
 
-    explicit dynamic_storage(size_type members) :
-      bytes(members * meta::mean_size_of(meta::identity<variant_type> {})),
+    basic_dynamic_storage(size_type members, size_type bytes, Allocator alloc) :
       count(0),
       offset(0),
-      types(members),
-      offsets(std::make_unique<initial_offset_storage>(members)),
-      data(new(std::align_val_t(max_alignment)) uint8_t[bytes])
+      types(members, alloc),
+      offsets(members, initial_offset_width, alloc),
+      data(bytes, alloc)
     {}
 
-    dynamic_storage(dynamic_storage const& other)
+    // Copies share the memory resource of the vector they were copied from.
+    basic_dynamic_storage(basic_dynamic_storage const& other)
       requires std::copyable<Variant>
     :
-      bytes(other.bytes),
       count(other.count),
       offset(other.offset),
       types(other.types),
-      offsets(other.offsets->clone()),
-      data(new (std::align_val_t(max_alignment)) uint8_t[bytes])
+      offsets(other.offsets),
+      data(other.buffer_size(), other.data.get_allocator())
     {
       if constexpr (std::is_trivially_copyable_v<Variant>) {
-        memcpy(get_data(), other.get_data(), bytes);
+        memcpy(get_data(), other.get_data(), offset);
       } else {
-        copy_storage<Variant>(count, types, *offsets, get_data(), other.get_data());
+        offsets.with_offsets([&] (auto const* offs) {
+          copy_storage<Variant>(count, types, offs, get_data(), other.get_data());
+        });
       }
     }
 
-    dynamic_storage(dynamic_storage&& other) noexcept :
-      bytes(other.bytes),
+    basic_dynamic_storage(basic_dynamic_storage&& other) noexcept :
       count(other.count),
       offset(other.offset),
       types(std::move(other.types)),
       offsets(std::move(other.offsets)),
       data(std::move(other.data))
     {
-      other.bytes = 0;
       other.count = 0;
       other.offset = 0;
     }
 
-    ~dynamic_storage() noexcept {
-      while (count) {
-        auto const curr_count = --count;
-        uint8_t const curr_type = types[curr_count];
-        auto const curr_offset = offsets->get(curr_count);
-        auto* const curr_ptr = get_data() + curr_offset;
-        get_typed_ptr_for(curr_type, curr_ptr, meta::identity<Variant> {}, [&] <class T> (T* value) {
-          value->~T();
+    ~basic_dynamic_storage() noexcept {
+      if constexpr (!std::is_trivially_destructible_v<Variant>) {
+        if (!count) return;
+        offsets.with_offsets([&] (auto const* offs) {
+          while (count) {
+            auto const curr_count = --count;
+            uint8_t const curr_type = types[curr_count];
+            auto* const curr_ptr = get_data() + offs[curr_count];
+            get_typed_ptr_for(curr_type, curr_ptr, meta::identity<Variant> {}, [&] <class T> (T* value) {
+              value->~T();
+            });
+          }
         });
       }
     }
@@ -1075,17 +2039,17 @@ namespace varvec::storage {
       return data[offset];
     }
 
-    dynamic_storage& operator =(dynamic_storage const& other) requires std::copyable<Variant> {
+    basic_dynamic_storage& operator =(basic_dynamic_storage const& other) requires std::copyable<Variant> {
       if (this == &other) return *this;
       auto tmp {other};
       *this = std::move(tmp);
       return *this;
     }
 
-    dynamic_storage& operator =(dynamic_storage&& other) noexcept {
+    basic_dynamic_storage& operator =(basic_dynamic_storage&& other) noexcept {
       if (this == &other) return *this;
-      this->~dynamic_storage();
-      new(this) dynamic_storage(std::move(other));
+      this->~basic_dynamic_storage();
+      new(this) basic_dynamic_storage(std::move(other));
       return *this;
     }
 
@@ -1100,79 +2064,103 @@ namespace varvec::storage {
     void set_offset(size_type idx, size_type val) noexcept {
       // Potentially reallocate our offset storage if its runtime
       // type can't represent the offset value we need to store.
-      if (!offsets->can_handle(val)) offsets = offsets->realloc_for(val);
-      offsets->set(idx, val);
+      if (!offsets.can_handle(val)) offsets.realloc_for(val);
+      offsets.set(idx, val);
     }
 
     size_type get_offset(size_type idx) const noexcept {
-      return offsets->get(idx);
+      return offsets.get(idx);
     }
 
     void incr_offset(size_type count) noexcept {
       offset += count;
     }
 
-    static void aligned_delete(uint8_t* ptr) noexcept {
-      operator delete[] (ptr, std::align_val_t(max_alignment));
+    template <class Func>
+    decltype(auto) with_offsets(Func&& callback) const {
+      return offsets.with_offsets(std::forward<Func>(callback));
+    }
+
+    template <class Func>
+    decltype(auto) with_offsets(Func&& callback) {
+      return offsets.with_offsets(std::forward<Func>(callback));
+    }
+
+    // Grows (never shrinks) the storage such that it can hold at least the given number
+    // of members and bytes.
+    //
+    // The offsets are widened up front to cover the whole data buffer, so that filling
+    // the reserved space never has to stop and widen them.
+    void reserve(size_type members, size_type bytes) {
+      if (bytes > buffer_size()) {
+        realloc(bytes);
+      }
+      if (members > max_members()) {
+        types.resize(members);
+      }
+      offsets.reserve(members, buffer_size());
     }
 
     uint8_t* resize(size_type scale) {
       // Update
-      data = realloc(bytes * scale);
-      bytes *= scale;
+      realloc(buffer_size() * scale);
       if (types.max_members() < count * scale) {
         types.resize(count * scale);
       }
-      if (offsets->size() < count * scale) {
-        offsets->resize(count * scale);
-      }
+      offsets.reserve(count * scale, buffer_size());
       return get_data() + offset;
     }
 
     void shrink_to_fit() {
       // Reallocate the storage region
-      data = realloc(offset);
+      realloc(offset);
 
       // Update all the book keeping
-      bytes = offset;
       types.resize(count);
-      offsets->resize(count);
+      offsets.resize(count);
     }
 
     size_type buffer_size() const noexcept {
-      return bytes;
+      return data.size();
     }
 
     size_type size() const noexcept {
-      return buffer_size() + (sizeof(uint8_t) * types.size()) + offsets->used_bytes();
+      return buffer_size() + (sizeof(uint8_t) * types.size()) + offsets.used_bytes();
     }
 
     size_type max_members() const noexcept {
-      return offsets->capacity();
+      return offsets.capacity();
     }
 
     bool has_space(size_type more) const noexcept {
-      return count < max_members() && offset + more < bytes;
+      return count < max_members() && offset + more <= buffer_size();
     }
 
-    std::unique_ptr<uint8_t[], deleter> realloc(size_type new_size) {
-      // Align some storage.
-      std::unique_ptr<uint8_t[], deleter> newdata {
-        new(std::align_val_t(max_alignment)) uint8_t[new_size]
-      };
+    Allocator get_allocator() const noexcept {
+      return data.get_allocator();
+    }
 
-      // Strong exception guarantee. Don't throw from moves
+    void realloc(size_type new_size) {
+      // Trivially copyable contents can be relocated bitwise, which lets the allocation
+      // policy resize the buffer without copying it, if it knows how.
       if constexpr (std::is_trivially_copyable_v<Variant>) {
-        memcpy(newdata.get(), data.get(), bytes);
-      } else if constexpr (std::is_nothrow_move_constructible_v<Variant>) {
-        move_storage<Variant>(count, types, *offsets, newdata.get(), data.get());
+        data.resize(new_size, offset);
       } else {
-        copy_storage<Variant>(count, types, *offsets, newdata.get(), data.get());
+        // Align some storage.
+        data_storage newdata {new_size, data.get_allocator()};
+
+        // Strong exception guarantee. Don't throw from moves
+        offsets.with_offsets([&] (auto const* offs) {
+          if constexpr (std::is_nothrow_move_constructible_v<Variant>) {
+            move_storage<Variant>(count, types, offs, newdata.get(), data.get());
+          } else {
+            copy_storage<Variant>(count, types, offs, newdata.get(), data.get());
+          }
+        });
+        data = std::move(newdata);
       }
-      return newdata;
     }
 
-    size_type bytes;
     size_type count;
     size_type offset;
 
@@ -1182,158 +2170,2828 @@ namespace varvec::storage {
 
   };
 
-  // Surrounding "context" type is necessary to adapt the template signature
-  // of the static storage types to get a consistent arity.
-  template <size_t max_bytes, size_t memcount>
-  struct static_storage_context {
-    template <class Variant>
-    using static_storage = std::conditional_t<
-      std::is_trivially_destructible_v<Variant>,
-      static_storage_base<Variant, max_bytes, memcount>,
-      destructible_static_storage_base<Variant, max_bytes, memcount>
-    >;
-  };
-
-}
+  template <class Variant>
+  using dynamic_storage = basic_dynamic_storage<Variant, default_allocator>;
 
-namespace varvec {
+  template <class Variant>
+  using pmr_storage = basic_dynamic_storage<Variant, resource_allocator>;
 
-  template <template <class> class, template <class...> class, meta::storable...>
-  class basic_variable_vector;
+  // Computes the sub-region boundaries for storage that keeps its data, offsets,
+  // and types in a single contiguous allocation.
+  //
+  // Data comes first so that it inherits the alignment of the block itself,
+  // followed by the offsets (aligned for the widest offset type), and then the type bitvec.
+  template <size_t type_bits>
+  struct block_layout {
 
-  template <template <class> class Storage,
-           template <class...> class Variant, meta::storable... Types>
-  class basic_variable_iterator {
+    using size_type = size_t;
 
-    public:
+    static constexpr size_type offset_alignment = alignof(uint64_t);
 
-      using container_type = basic_variable_vector<Storage, Variant, Types...>;
+    constexpr size_type offsets_begin() const noexcept {
+      return (data_bytes + offset_alignment - 1) & ~(offset_alignment - 1);
+    }
 
-      using iterator_category = std::random_access_iterator_tag;
-      using value_type = typename container_type::value_type;
-      using difference_type = typename container_type::difference_type;
-      using reference = value_type&;
-      using size_type = typename container_type::size_type;
+    constexpr size_type types_begin() const noexcept {
+      return offsets_begin() + members * width;
+    }
 
-      // Because default construction is useful.
-      // Be careful!
-      basic_variable_iterator() noexcept :
-        idx(0),
-        storage(nullptr)
-      {}
+    constexpr size_type types_bytes() const noexcept {
+      return (members * type_bits + CHAR_BIT - 1) / CHAR_BIT;
+    }
 
-      basic_variable_iterator(basic_variable_iterator const& other) noexcept :
-        idx(other.idx),
-        storage(other.storage)
-      {}
+    constexpr size_type total_bytes() const noexcept {
+      return types_begin() + types_bytes();
+    }
 
-      basic_variable_iterator& operator =(basic_variable_iterator const& other) noexcept {
-        if (&other == this) {
-          return *this;
-        }
-        idx = other.idx;
-        storage = other.storage;
-        return *this;
-      }
+    size_type data_bytes;
+    size_type members;
+    size_type width;
 
-      value_type operator *() const
-        noexcept(std::is_nothrow_copy_constructible_v<value_type>)
-      {
-        return (*storage)[idx];
-      }
+  };
 
-      basic_variable_iterator& operator ++() noexcept {
-        ++idx;
-        return *this;
-      }
+  // Dynamically sized buffer storage that keeps its data, offsets, and types
+  // in one aligned allocation.
+  //
+  // Compared to basic_dynamic_storage, a lookup touches one allocation instead of three,
+  // small vectors fit into fewer cache lines, and growth costs a single allocation
+  // and copy.
+  //
+  // Since widening the offsets would require re-laying out the whole block, the offset width
+  // is instead chosen up front, whenever the block is laid out, based on the data capacity.
+  // This means set_offset never allocates, and never moves anything.
+  template <class Variant, class Allocator>
+  struct basic_block_storage {
 
-      basic_variable_iterator& operator --() noexcept {
-        --idx;
-        return *this;
-      }
+    using size_type = size_t;
+    using variant_type = Variant;
+    using allocator_type = Allocator;
 
-      basic_variable_iterator operator ++(int) noexcept {
-        auto tmp {*this};
-        ++idx;
-        return tmp;
-      }
+    static constexpr auto start_members = 8;
+    static constexpr auto start_size = start_members * meta::mean_size_of(meta::identity<variant_type> {});
+    static constexpr auto max_alignment = std::max(
+      meta::max_alignment_of(meta::identity<variant_type> {}),
+      block_layout<1>::offset_alignment
+    );
 
-      basic_variable_iterator operator --(int) noexcept {
-        auto tmp {*this};
-        --idx;
-        return tmp;
-      }
+    static constexpr auto num_types = meta::num_types_in(meta::identity<Variant> {});
+    static constexpr auto type_bits = meta::rounded_bits_for<num_types - 1>();
 
-    private:
+    static constexpr bool has_nothrow_resize = false;
 
-      basic_variable_iterator(size_type idx, container_type const* storage) noexcept :
-        idx(idx),
-        storage(storage)
-      {}
+    static_assert(type_bits <= 8,
+        "varvec block storage cannot currently be parameterized with more than 256 types");
 
-      friend class basic_variable_vector<Storage, Variant, Types...>;
+    using layout_type = block_layout<type_bits>;
+    using type_storage = bitvec_api<type_bits, bitvec_view_storage>;
+    using block_storage = byte_buffer<Allocator, max_alignment>;
 
-      size_type idx;
-      container_type const* storage;
+    explicit basic_block_storage(Allocator alloc = Allocator {}) :
+      basic_block_storage(start_members, start_size, alloc)
+    {}
 
-      friend bool operator ==(basic_variable_iterator const& lhs, basic_variable_iterator const& rhs) noexcept {
-        return lhs.idx == rhs.idx && lhs.storage == rhs.storage;
-      }
+    explicit basic_block_storage(size_type members, Allocator alloc = Allocator {}) :
+      basic_block_storage(members, members * meta::mean_size_of(meta::identity<variant_type> {}), alloc)
+    {}
+
+    basic_block_storage(size_type members, size_type bytes, Allocator alloc) :
+      count(0),
+      offset(0),
+      layout(layout_for(bytes, members)),
+      block(layout.total_bytes(), alloc)
+    {
+      memset(block.get() + layout.types_begin(), 0, layout.types_bytes());
+      bind();
+    }
+
+    basic_block_storage(basic_block_storage const& other)
+      requires std::copyable<Variant>
+    :
+      count(other.count),
+      offset(other.offset),
+      layout(other.layout),
+      block(layout.total_bytes(), other.block.get_allocator())
+    {
+      // All of the metadata can be copied in one shot.
+      auto const metadata_begin = layout.offsets_begin();
+      memcpy(block.get() + metadata_begin,
+          other.block.get() + metadata_begin, layout.total_bytes() - metadata_begin);
+      bind();
+
+      if constexpr (std::is_trivially_copyable_v<Variant>) {
+        memcpy(get_data(), other.get_data(), offset);
+      } else {
+        with_offsets([&] (auto const* offs) {
+          copy_storage<Variant>(count, types, offs, get_data(), other.get_data());
+        });
+      }
+    }
+
+    basic_block_storage(basic_block_storage&& other) noexcept :
+      count(other.count),
+      offset(other.offset),
+      layout(other.layout),
+      block(std::move(other.block)),
+      types(other.types)
+    {
+      other.count = 0;
+      other.offset = 0;
+      other.layout = layout_for(0, 0);
+      other.types = type_storage {};
+    }
+
+    ~basic_block_storage() noexcept {
+      if constexpr (!std::is_trivially_destructible_v<Variant>) {
+        destroy_all();
+      }
+    }
+
+    uint8_t operator [](size_type offset) const noexcept {
+      return get_data()[offset];
+    }
+
+    basic_block_storage& operator =(basic_block_storage const& other) requires std::copyable<Variant> {
+      if (this == &other) return *this;
+      auto tmp {other};
+      *this = std::move(tmp);
+      return *this;
+    }
+
+    basic_block_storage& operator =(basic_block_storage&& other) noexcept {
+      if (this == &other) return *this;
+      this->~basic_block_storage();
+      new(this) basic_block_storage(std::move(other));
+      return *this;
+    }
+
+    uint8_t* get_data() noexcept {
+      return block.get();
+    }
+
+    uint8_t const* get_data() const noexcept {
+      return block.get();
+    }
+
+    template <class Func>
+    decltype(auto) with_offsets(Func&& callback) const {
+      return offsets::dispatch_width(layout.width, [&] <class T> (meta::identity<T>) -> decltype(auto) {
+        return std::forward<Func>(callback)(reinterpret_cast<T const*>(block.get() + layout.offsets_begin()));
+      });
+    }
+
+    template <class Func>
+    decltype(auto) with_offsets(Func&& callback) {
+      return offsets::dispatch_width(layout.width, [&] <class T> (meta::identity<T>) -> decltype(auto) {
+        return std::forward<Func>(callback)(reinterpret_cast<T*>(block.get() + layout.offsets_begin()));
+      });
+    }
+
+    void set_offset(size_type idx, size_type val) noexcept {
+      assert(offsets::width_for(val) <= layout.width);
+      with_offsets([&] <class T> (T* offs) {
+        offs[idx] = static_cast<T>(val);
+      });
+    }
+
+    size_type get_offset(size_type idx) const noexcept {
+      return with_offsets([&] (auto const* offs) -> size_type {
+        return offs[idx];
+      });
+    }
+
+    void incr_offset(size_type count) noexcept {
+      offset += count;
+    }
+
+    void reserve(size_type members, size_type bytes) {
+      if (members > max_members() || bytes > buffer_size()) {
+        relayout(layout_for(std::max(bytes, buffer_size()), std::max(members, max_members())));
+      }
+    }
+
+    uint8_t* resize(size_type scale) {
+      relayout(layout_for(buffer_size() * scale, std::max(max_members(), count * scale)));
+      return get_data() + offset;
+    }
+
+    void shrink_to_fit() {
+      relayout(layout_for(offset, count));
+    }
+
+    size_type buffer_size() const noexcept {
+      return layout.data_bytes;
+    }
+
+    size_type size() const noexcept {
+      return block.size();
+    }
+
+    size_type max_members() const noexcept {
+      return layout.members;
+    }
+
+    bool has_space(size_type more) const noexcept {
+      return count < max_members() && offset + more <= buffer_size();
+    }
+
+    Allocator get_allocator() const noexcept {
+      return block.get_allocator();
+    }
+
+    // Function moves everything into a freshly allocated block with the given layout.
+    // One allocation, and one pass over each region.
+    void relayout(layout_type new_layout) {
+      assert(new_layout.data_bytes >= offset && new_layout.members >= count);
+      block_storage newblock {new_layout.total_bytes(), block.get_allocator()};
+      auto* const newbase = newblock.get();
+
+      // Offsets, converting to the new width if necessary.
+      with_offsets([&] (auto const* src) {
+        offsets::dispatch_width(new_layout.width, [&] <class T> (meta::identity<T>) {
+          std::copy(src, src + count, reinterpret_cast<T*>(newbase + new_layout.offsets_begin()));
+        });
+      });
+
+      // Types.
+      auto const type_bytes = std::min(layout.types_bytes(), new_layout.types_bytes());
+      memcpy(newbase + new_layout.types_begin(), block.get() + layout.types_begin(), type_bytes);
+      memset(newbase + new_layout.types_begin() + type_bytes, 0, new_layout.types_bytes() - type_bytes);
+
+      // Data. Strong exception guarantee. Don't throw from moves
+      if constexpr (std::is_trivially_copyable_v<Variant>) {
+        memcpy(newbase, get_data(), offset);
+      } else {
+        with_offsets([&] (auto const* offs) {
+          if constexpr (std::is_nothrow_move_constructible_v<Variant>) {
+            move_storage<Variant>(count, types, offs, newbase, get_data());
+          } else {
+            copy_storage<Variant>(count, types, offs, newbase, get_data());
+          }
+        });
+        destroy_all();
+      }
+
+      layout = new_layout;
+      block = std::move(newblock);
+      bind();
+    }
+
+    static constexpr layout_type layout_for(size_type bytes, size_type members) noexcept {
+      return layout_type {bytes, members, offsets::width_for(bytes)};
+    }
+
+    // Points the type bitvec at its region of the current block.
+    void bind() noexcept {
+      types = type_storage {layout.types_bytes(), block.get() + layout.types_begin()};
+    }
+
+    // Destroys every live object without touching the bookkeeping.
+    void destroy_all() noexcept {
+      if (!count) return;
+      with_offsets([&] (auto const* offs) {
+        auto* const base = get_data();
+        for (size_type i = 0; i < count; ++i) {
+          uint8_t const curr_type = types[i];
+          get_typed_ptr_for(curr_type, base + offs[i], meta::identity<Variant> {}, [&] <class T> (T* value) {
+            value->~T();
+          });
+        }
+      });
+    }
+
+    size_type count;
+    size_type offset;
+
+    layout_type layout;
+    block_storage block;
+    type_storage types;
+
+  };
+
+  template <class Variant>
+  using block_storage = basic_block_storage<Variant, default_allocator>;
+
+#ifdef __linux__
+  // File backed buffer storage.
+  //
+  // Uses the same single block layout as basic_block_storage (data, then offsets, then types),
+  // but keeps the block in a shared mapping of a file, behind a small header.
+  // Growth extends the file with ftruncate and remaps it with mremap, so the kernel moves
+  // page table entries instead of the storage copying data, and the contents outlive the
+  // process. Reopening a file picks up the vector exactly where it was left.
+  //
+  // Counts are written back to the file header on sync, relayout, and destruction.
+  // Default constructed (and copied) instances use an anonymous mapping, and don't persist.
+  //
+  // Only trivially copyable types can be stored, since nothing else survives a restart.
+  template <class Variant>
+  struct mapped_storage {
+
+    using size_type = size_t;
+    using variant_type = Variant;
+
+    static constexpr auto start_members = 8;
+    static constexpr auto start_size = start_members * meta::mean_size_of(meta::identity<variant_type> {});
+    static constexpr auto max_alignment = meta::max_alignment_of(meta::identity<variant_type> {});
+
+    static constexpr auto num_types = meta::num_types_in(meta::identity<Variant> {});
+    static constexpr auto type_bits = meta::rounded_bits_for<num_types - 1>();
+
+    static constexpr bool has_nothrow_resize = false;
+
+    // Data begins this far into the mapping, which keeps it aligned.
+    static constexpr size_type header_bytes = 64;
+
+    static_assert(type_bits <= 8,
+        "varvec mapped storage cannot currently be parameterized with more than 256 types");
+    static_assert(std::is_trivially_copyable_v<Variant>,
+        "varvec mapped storage can only store trivially copyable types");
+    static_assert(sizeof(serialization::mapped_header) <= header_bytes && max_alignment <= header_bytes);
+
+    using layout_type = block_layout<type_bits>;
+    using type_storage = bitvec_api<type_bits, bitvec_view_storage>;
+
+    mapped_storage() :
+      mapped_storage(start_members, start_size)
+    {}
+
+    explicit mapped_storage(size_type members) :
+      mapped_storage(members, members * meta::mean_size_of(meta::identity<variant_type> {}))
+    {}
+
+    mapped_storage(size_type members, size_type bytes) :
+      fd(-1),
+      count(0),
+      offset(0),
+      layout(layout_for(bytes, members)),
+      mapping(map(mapped_bytes()))
+    {
+      bind();
+    }
+
+    // Opens, or creates, the file at the given path.
+    // Throws std::system_error if the file can't be opened or mapped, and std::invalid_argument
+    // if it exists, but wasn't written by a vector of the same types.
+    explicit mapped_storage(std::filesystem::path const& path) :
+      fd(::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)),
+      count(0),
+      offset(0),
+      layout(layout_for(start_size, start_members)),
+      mapping(nullptr)
+    {
+      if (fd < 0) throw_errno("open");
+
+      try {
+        struct stat info;
+        if (::fstat(fd, &info)) throw_errno("fstat");
+
+        size_type const file_bytes = info.st_size;
+        if (file_bytes == 0) {
+          if (::ftruncate(fd, mapped_bytes())) throw_errno("ftruncate");
+          mapping = map(mapped_bytes());
+          bind();
+          write_header();
+        } else {
+          serialization::mapped_header head;
+          if (file_bytes < header_bytes || ::pread(fd, &head, sizeof(head), 0) != sizeof(head)) {
+            throw std::invalid_argument("varvec file is too small to contain a header");
+          }
+          serialization::check_header<Variant>(head.common, serialization::mapped_magic);
+
+          layout = layout_type {head.bytes_capacity, head.members_capacity, head.common.offset_width};
+          if (head.common.count > layout.members || head.common.data_bytes > layout.data_bytes
+              || file_bytes < mapped_bytes()) {
+            throw std::invalid_argument("varvec file is truncated or corrupt");
+          }
+          mapping = map(mapped_bytes());
+          count = head.common.count;
+          offset = head.common.data_bytes;
+          bind();
+        }
+      } catch (...) {
+        if (mapping) ::munmap(mapping, mapped_bytes());
+        ::close(fd);
+        throw;
+      }
+    }
+
+    // Copies are anonymous, they don't share or duplicate the file.
+    mapped_storage(mapped_storage const& other) :
+      fd(-1),
+      count(other.count),
+      offset(other.offset),
+      layout(other.layout),
+      mapping(map(mapped_bytes()))
+    {
+      memcpy(mapping + header_bytes, other.mapping + header_bytes, layout.total_bytes());
+      bind();
+    }
+
+    mapped_storage(mapped_storage&& other) noexcept :
+      fd(other.fd),
+      count(other.count),
+      offset(other.offset),
+      layout(other.layout),
+      mapping(other.mapping),
+      data(other.data),
+      types(other.types)
+    {
+      other.fd = -1;
+      other.count = 0;
+      other.offset = 0;
+      other.layout = layout_for(0, 0);
+      other.mapping = nullptr;
+      other.data = nullptr;
+      other.types = type_storage {};
+    }
+
+    ~mapped_storage() noexcept {
+      if (mapping) {
+        if (fd >= 0) write_header();
+        ::munmap(mapping, mapped_bytes());
+      }
+      if (fd >= 0) ::close(fd);
+    }
+
+    uint8_t operator [](size_type offset) const noexcept {
+      return get_data()[offset];
+    }
+
+    mapped_storage& operator =(mapped_storage const& other) {
+      if (this == &other) return *this;
+      auto tmp {other};
+      *this = std::move(tmp);
+      return *this;
+    }
+
+    mapped_storage& operator =(mapped_storage&& other) noexcept {
+      if (this == &other) return *this;
+      this->~mapped_storage();
+      new(this) mapped_storage(std::move(other));
+      return *this;
+    }
+
+    uint8_t* get_data() noexcept {
+      return data;
+    }
+
+    uint8_t const* get_data() const noexcept {
+      return data;
+    }
+
+    template <class Func>
+    decltype(auto) with_offsets(Func&& callback) const {
+      return offsets::dispatch_width(layout.width, [&] <class T> (meta::identity<T>) -> decltype(auto) {
+        return std::forward<Func>(callback)(reinterpret_cast<T const*>(data + layout.offsets_begin()));
+      });
+    }
+
+    template <class Func>
+    decltype(auto) with_offsets(Func&& callback) {
+      return offsets::dispatch_width(layout.width, [&] <class T> (meta::identity<T>) -> decltype(auto) {
+        return std::forward<Func>(callback)(reinterpret_cast<T*>(data + layout.offsets_begin()));
+      });
+    }
+
+    void set_offset(size_type idx, size_type val) noexcept {
+      assert(offsets::width_for(val) <= layout.width);
+      with_offsets([&] <class T> (T* offs) {
+        offs[idx] = static_cast<T>(val);
+      });
+    }
+
+    size_type get_offset(size_type idx) const noexcept {
+      return with_offsets([&] (auto const* offs) -> size_type {
+        return offs[idx];
+      });
+    }
+
+    void incr_offset(size_type count) noexcept {
+      offset += count;
+    }
+
+    void reserve(size_type members, size_type bytes) {
+      if (members > max_members() || bytes > buffer_size()) {
+        relayout(layout_for(std::max(bytes, buffer_size()), std::max(members, max_members())));
+      }
+    }
+
+    uint8_t* resize(size_type scale) {
+      relayout(layout_for(buffer_size() * scale, std::max(max_members(), count * scale)));
+      return get_data() + offset;
+    }
+
+    // Function writes the current counts to the file header, and flushes the mapping to disk.
+    void sync() {
+      if (fd < 0) return;
+      write_header();
+      if (::msync(mapping, mapped_bytes(), MS_SYNC)) throw_errno("msync");
+    }
+
+    size_type buffer_size() const noexcept {
+      return layout.data_bytes;
+    }
+
+    size_type size() const noexcept {
+      return mapped_bytes();
+    }
+
+    size_type max_members() const noexcept {
+      return layout.members;
+    }
+
+    bool has_space(size_type more) const noexcept {
+      return count < max_members() && offset + more <= buffer_size();
+    }
+
+    // Function grows the mapping, and the file if there is one, to fit the given layout.
+    //
+    // Data stays where it is, at the front of the block. Both metadata regions only ever move
+    // towards the end of the block, so they're shifted in place, types first so that the
+    // offsets don't overwrite them.
+    void relayout(layout_type new_layout) {
+      assert(new_layout.data_bytes >= layout.data_bytes && new_layout.members >= layout.members);
+      assert(new_layout.width >= layout.width);
+      auto const new_bytes = header_bytes + new_layout.total_bytes();
+
+      if (fd >= 0 && ::ftruncate(fd, new_bytes)) throw_errno("ftruncate");
+      if (mapping) {
+        auto* const remapped = ::mremap(mapping, mapped_bytes(), new_bytes, MREMAP_MAYMOVE);
+        if (remapped == MAP_FAILED) throw_errno("mremap");
+        mapping = static_cast<uint8_t*>(remapped);
+      } else {
+        // Moved from.
+        mapping = map(new_bytes);
+      }
+
+      auto* const block = mapping + header_bytes;
+      memmove(block + new_layout.types_begin(), block + layout.types_begin(), layout.types_bytes());
+      memset(block + new_layout.types_begin() + layout.types_bytes(), 0,
+          new_layout.types_bytes() - layout.types_bytes());
+
+      // Back to front, since the offsets may be getting wider.
+      offsets::dispatch_width(layout.width, [&] <class S> (meta::identity<S>) {
+        offsets::dispatch_width(new_layout.width, [&] <class D> (meta::identity<D>) {
+          auto const* const src = reinterpret_cast<S const*>(block + layout.offsets_begin());
+          auto* const dst = reinterpret_cast<D*>(block + new_layout.offsets_begin());
+          if constexpr (std::is_same_v<S, D>) {
+            memmove(dst, src, count * sizeof(D));
+          } else {
+            for (size_type i = count; i > 0; --i) {
+              D const val = src[i - 1];
+              dst[i - 1] = val;
+            }
+          }
+        });
+      });
+
+      layout = new_layout;
+      bind();
+      if (fd >= 0) write_header();
+    }
+
+    static constexpr layout_type layout_for(size_type bytes, size_type members) noexcept {
+      return layout_type {bytes, members, offsets::width_for(bytes)};
+    }
+
+    size_type mapped_bytes() const noexcept {
+      return header_bytes + layout.total_bytes();
+    }
+
+    // Function maps the given number of bytes of the file, or of anonymous memory if there isn't one.
+    uint8_t* map(size_type bytes) const {
+      auto const flags = fd >= 0 ? MAP_SHARED : MAP_PRIVATE | MAP_ANONYMOUS;
+      auto* const ptr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, fd, 0);
+      if (ptr == MAP_FAILED) throw_errno("mmap");
+      return static_cast<uint8_t*>(ptr);
+    }
+
+    // Points the data pointer and the type bitvec at their regions of the current mapping.
+    void bind() noexcept {
+      data = mapping + header_bytes;
+      types = type_storage {layout.types_bytes(), data + layout.types_begin()};
+    }
+
+    void write_header() noexcept {
+      serialization::mapped_header const head {
+        {
+          serialization::mapped_magic,
+          serialization::current_version,
+          std::endian::native == std::endian::little,
+          static_cast<uint8_t>(layout.width),
+          serialization::signature_v<Variant>,
+          count,
+          offset
+        },
+        layout.members,
+        layout.data_bytes
+      };
+      memcpy(mapping, &head, sizeof(head));
+    }
+
+    [[noreturn]] static void throw_errno(char const* call) {
+      throw std::system_error(errno, std::generic_category(), std::string("varvec mapped storage: ") + call);
+    }
+
+    int fd;
+    size_type count;
+    size_type offset;
+
+    layout_type layout;
+    uint8_t* mapping;
+    uint8_t* data;
+    type_storage types;
+
+  };
+#endif
+
+  // Hybrid buffer storage.
+  // Data, types, and offsets all live inline, exactly like static_storage_base, until
+  // the vector outgrows them, at which point everything migrates to the heap
+  // and the class behaves like dynamic_storage from then on.
+  template <class Variant, size_t bytes, size_t memcount>
+  struct small_storage_base {
+
+    using size_type = size_t;
+    using variant_type = Variant;
+
+    static constexpr auto num_types = meta::num_types_in(meta::identity<Variant> {});
+    static constexpr auto type_bits = meta::rounded_bits_for<num_types - 1>();
+
+    static constexpr auto start_size = bytes;
+    static constexpr auto max_alignment = meta::max_alignment_of(meta::identity<variant_type> {});
+
+    static constexpr bool has_nothrow_resize = false;
+
+    static_assert(type_bits <= 8,
+        "varvec::small_vector cannot currently be parameterized with more than 256 types");
+
+    // Offsets are stored in the smallest type that can represent the inline buffer
+    // until we spill, and in runtime-width storage afterwards.
+    using packed_size_type = meta::smallest_type_for_t<std::max({bytes, memcount})>;
+    using inline_offset_storage = std::array<packed_size_type, memcount>;
+    using heap_offset_storage = std::optional<offsets::dynamic_offset_storage>;
+
+    using type_storage = small_bitvec<type_bits, memcount>;
+
+    // Must match the alignment of the heap buffer so that offsets (and therefore
+    // alignment padding) remain valid when we migrate.
+    using storage_type = std::aligned_storage_t<bytes, max_alignment>;
+
+    using deleter = aligned_deleter<uint8_t, std::align_val_t(max_alignment)>;
+
+    using data_storage = std::unique_ptr<uint8_t[], deleter>;
+
+    small_storage_base() noexcept :
+      bytes_capacity(bytes),
+      member_capacity(memcount),
+      count(0),
+      offset(0),
+      types(),
+      inline_offsets({0}),
+      heap_offsets(),
+      heap_data(nullptr)
+    {}
+
+    explicit small_storage_base(size_type members) : small_storage_base() {
+      if (members > memcount) {
+        spill(std::max(bytes, members * meta::mean_size_of(meta::identity<variant_type> {})), members);
+      }
+    }
+
+    small_storage_base(small_storage_base const& other)
+      requires std::copyable<Variant>
+    :
+      bytes_capacity(other.bytes_capacity),
+      member_capacity(other.member_capacity),
+      count(other.count),
+      offset(other.offset),
+      types(other.types),
+      inline_offsets(other.inline_offsets),
+      heap_offsets(other.heap_offsets),
+      heap_data(nullptr)
+    {
+      if (other.spilled()) {
+        heap_data.reset(new(std::align_val_t(max_alignment)) uint8_t[bytes_capacity]);
+      }
+      if constexpr (std::is_trivially_copyable_v<Variant>) {
+        memcpy(get_data(), other.get_data(), offset);
+      } else {
+        with_offsets([&] (auto const* offs) {
+          copy_storage<Variant>(count, types, offs, get_data(), other.get_data());
+        });
+      }
+    }
+
+    small_storage_base(small_storage_base&& other)
+      noexcept(std::is_nothrow_move_constructible_v<Variant>)
+    :
+      bytes_capacity(other.bytes_capacity),
+      member_capacity(other.member_capacity),
+      count(other.count),
+      offset(other.offset),
+      types(std::move(other.types)),
+      inline_offsets(other.inline_offsets),
+      heap_offsets(std::move(other.heap_offsets)),
+      heap_data(std::move(other.heap_data))
+    {
+      if (spilled()) {
+        // We stole the heap buffer, reset the other vector back to an empty inline state.
+        other.heap_offsets.reset();
+        other.bytes_capacity = bytes;
+        other.member_capacity = memcount;
+        other.count = 0;
+        other.offset = 0;
+      } else if constexpr (std::is_trivially_copyable_v<Variant>) {
+        memcpy(get_data(), other.get_data(), offset);
+      } else if constexpr (std::is_nothrow_move_constructible_v<Variant>) {
+        move_storage<Variant>(count, types, inline_offsets, get_data(), other.get_data());
+      } else {
+        // Fall back on copies if all the types aren't nothrow move to ensure we don't
+        // corrupt the new storage class if something throws.
+        copy_storage<Variant>(count, types, inline_offsets, get_data(), other.get_data());
+      }
+    }
+
+    ~small_storage_base() noexcept {
+      if constexpr (!std::is_trivially_destructible_v<Variant>) {
+        destroy_all();
+      }
+    }
+
+    uint8_t operator [](size_type offset) const noexcept {
+      return get_data()[offset];
+    }
+
+    small_storage_base& operator =(small_storage_base const& other) requires std::copyable<Variant> {
+      if (this == &other) return *this;
+      auto tmp {other};
+      *this = std::move(tmp);
+      return *this;
+    }
+
+    small_storage_base& operator =(small_storage_base&& other)
+      noexcept(std::is_nothrow_move_constructible_v<Variant>)
+    {
+      if (this == &other) return *this;
+      this->~small_storage_base();
+      new(this) small_storage_base(std::move(other));
+      return *this;
+    }
+
+    uint8_t* get_data() noexcept {
+      if (spilled()) return heap_data.get();
+      return reinterpret_cast<uint8_t*>(&inline_data);
+    }
+
+    uint8_t const* get_data() const noexcept {
+      if (spilled()) return heap_data.get();
+      return reinterpret_cast<uint8_t const*>(&inline_data);
+    }
+
+    void set_offset(size_type idx, size_type val) noexcept {
+      if (spilled()) {
+        if (!heap_offsets->can_handle(val)) heap_offsets->realloc_for(val);
+        heap_offsets->set(idx, val);
+      } else {
+        inline_offsets[idx] = val;
+      }
+    }
+
+    size_type get_offset(size_type idx) const noexcept {
+      if (spilled()) return heap_offsets->get(idx);
+      return inline_offsets[idx];
+    }
+
+    void incr_offset(size_type count) noexcept {
+      offset += count;
+    }
+
+    // Function invokes the given callback with an indexable view of the current offsets.
+    template <class Func>
+    decltype(auto) with_offsets(Func&& callback) const {
+      if (spilled()) return heap_offsets->with_offsets(std::forward<Func>(callback));
+      return std::forward<Func>(callback)(inline_offsets.data());
+    }
+
+    template <class Func>
+    decltype(auto) with_offsets(Func&& callback) {
+      if (spilled()) return heap_offsets->with_offsets(std::forward<Func>(callback));
+      return std::forward<Func>(callback)(inline_offsets.data());
+    }
+
+    void reserve(size_type members, size_type data_bytes) {
+      if (members > max_members() || data_bytes > buffer_size()) {
+        spill(std::max(data_bytes, buffer_size()), std::max(members, max_members()));
+      }
+    }
+
+    uint8_t* resize(size_type scale) {
+      spill(bytes_capacity * scale, std::max(member_capacity, count * scale));
+      return get_data() + offset;
+    }
+
+    size_type buffer_size() const noexcept {
+      return bytes_capacity;
+    }
+
+    size_type size() const noexcept {
+      auto total = sizeof(types) + sizeof(inline_offsets) + sizeof(inline_data);
+      if (spilled()) total += bytes_capacity + types.size() + heap_offsets->used_bytes();
+      return total;
+    }
+
+    size_type max_members() const noexcept {
+      return member_capacity;
+    }
+
+    bool has_space(size_type more) const noexcept {
+      return count < max_members() && offset + more <= bytes_capacity;
+    }
+
+    bool spilled() const noexcept {
+      return heap_data != nullptr;
+    }
+
+    // Function migrates (or grows) our storage onto the heap.
+    // Provides the strong exception guarantee as long as moves don't throw.
+    void spill(size_type new_bytes, size_type new_members) {
+      data_storage newdata {new(std::align_val_t(max_alignment)) uint8_t[new_bytes]};
+
+      // Build up the new offsets on the side.
+      heap_offset_storage newoffsets;
+      if (spilled()) {
+        newoffsets.emplace(*heap_offsets);
+        newoffsets->resize(new_members);
+      } else {
+        newoffsets.emplace(new_members, sizeof(packed_size_type));
+        for (size_type i = 0; i < count; ++i) newoffsets->set(i, inline_offsets[i]);
+      }
+      types.resize(new_members);
+
+      // Relocate the data. Types and offsets are unchanged, since both buffers
+      // share the same base alignment.
+      if constexpr (std::is_trivially_copyable_v<Variant>) {
+        memcpy(newdata.get(), get_data(), offset);
+      } else {
+        newoffsets->with_offsets([&] (auto const* offs) {
+          if constexpr (std::is_nothrow_move_constructible_v<Variant>) {
+            move_storage<Variant>(count, types, offs, newdata.get(), get_data());
+          } else {
+            copy_storage<Variant>(count, types, offs, newdata.get(), get_data());
+          }
+        });
+        destroy_all();
+      }
+
+      bytes_capacity = new_bytes;
+      member_capacity = new_members;
+      heap_offsets = std::move(newoffsets);
+      heap_data = std::move(newdata);
+    }
+
+    // Destroys every live object without touching the bookkeeping.
+    void destroy_all() noexcept {
+      if (!count) return;
+      with_offsets([&] (auto const* offs) {
+        auto* const base = get_data();
+        for (size_type i = 0; i < count; ++i) {
+          uint8_t const curr_type = types[i];
+          get_typed_ptr_for(curr_type, base + offs[i], meta::identity<Variant> {}, [&] <class T> (T* value) {
+            value->~T();
+          });
+        }
+      });
+    }
+
+    size_type bytes_capacity;
+    size_type member_capacity;
+    size_type count;
+    size_type offset;
+
+    type_storage types;
+    inline_offset_storage inline_offsets;
+    heap_offset_storage heap_offsets;
+    data_storage heap_data;
+    storage_type inline_data;
+
+  };
+
+  // Surrounding "context" type is necessary to adapt the template signature
+  // of the static storage types to get a consistent arity.
+  template <size_t max_bytes, size_t memcount>
+  struct static_storage_context {
+    template <class Variant>
+    using static_storage = std::conditional_t<
+      std::is_trivially_destructible_v<Variant>,
+      static_storage_base<Variant, max_bytes, memcount>,
+      destructible_static_storage_base<Variant, max_bytes, memcount>
+    >;
+  };
+
+  template <size_t inline_bytes, size_t inline_members>
+  struct small_storage_context {
+    template <class Variant>
+    using small_storage = small_storage_base<Variant, inline_bytes, inline_members>;
+  };
+
+}
+
+namespace varvec {
+
+  template <template <class> class, template <class...> class, meta::storable...>
+  class basic_variable_vector;
+
+  template <template <class...> class, meta::storable...>
+  class basic_variable_view;
+
+  template <class, class>
+  class basic_typed_view;
+
+  template <size_t, size_t, template <class...> class, meta::storable...>
+  class basic_segmented_vector;
+
+  // Lightweight handle to a single member of a packed vector, returned when dereferencing
+  // an iterator. Holds the type tag and the address of the member, so reading through it
+  // is zero-copy: visit hands the callback a reference into the vector's storage,
+  // and a full value_type is only built when one is asked for.
+  //
+  // Invalidated by anything that would invalidate the iterator it came from.
+  template <template <class...> class Variant, meta::storable... Types>
+  class basic_variable_reference {
+
+    public:
+
+      using value_type = Variant<meta::copyable_type_for_t<Types>...>;
+      using logical_type = Variant<Types...>;
+
+      basic_variable_reference(uint8_t type, uint8_t const* ptr) noexcept :
+        type(type),
+        ptr(ptr)
+      {}
+
+      // Index of the member's type in the type list, like std::variant::index.
+      size_t index() const noexcept {
+        return type;
+      }
+
+      template <class T>
+      bool holds_alternative() const noexcept {
+        return type == meta::index_of_v<T, Types...>;
+      }
+
+      // Function invokes the callback with a const reference to the member.
+      template <class Func>
+      requires (std::is_invocable_v<Func, Types const&> && ...)
+      decltype(auto) visit(Func&& callback) const
+        noexcept((std::is_nothrow_invocable_v<Func, Types const&> && ...))
+      {
+        return storage::get_aligned_ptr_for(type, ptr,
+            meta::identity<logical_type> {}, [&] <class T> (T const* val) -> decltype(auto) {
+          return std::forward<Func>(callback)(*val);
+        });
+      }
+
+      // Materializes the member, the same way operator [] does.
+      operator value_type() const noexcept(std::is_nothrow_copy_constructible_v<value_type>) {
+        return storage::get_aligned_ptr_for(type, ptr, meta::identity<logical_type> {},
+            [] <class T> (T const* val) -> value_type {
+          if constexpr (std::copyable<T>) return *val;
+          else return val;
+        });
+      }
+
+    private:
+
+      uint8_t type;
+      uint8_t const* ptr;
+
+      friend bool operator ==(basic_variable_reference const& lhs, value_type const& rhs) {
+        if (lhs.index() != rhs.index()) return false;
+        return lhs.visit([&] <class T> (T const& val) {
+          auto const& other = *std::get_if<meta::index_of_v<T, Types...>>(&rhs);
+          if constexpr (std::copyable<T>) return val == other;
+          else return &val == other;
+        });
+      }
+
+      friend bool operator ==(basic_variable_reference const& lhs, basic_variable_reference const& rhs) {
+        if (lhs.index() != rhs.index()) return false;
+        return lhs.visit([&] <class T> (T const& val) {
+          if constexpr (std::is_trivially_copyable_v<T>) {
+            // Could be misaligned.
+            alignas(T) std::byte other[sizeof(T)];
+            memcpy(other, rhs.ptr, sizeof(T));
+            return val == *std::launder(reinterpret_cast<T const*>(other));
+          } else {
+            return val == *reinterpret_cast<T const*>(rhs.ptr);
+          }
+        });
+      }
+
+  };
+
+  // Random access iterator shared by the owning vectors and the non-owning views.
+  template <class Container>
+  class basic_variable_iterator {
+
+    public:
+
+      using container_type = Container;
+
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = typename container_type::value_type;
+      using difference_type = typename container_type::difference_type;
+      using reference = typename container_type::reference;
+      using size_type = typename container_type::size_type;
+
+      // Because default construction is useful.
+      // Be careful!
+      basic_variable_iterator() noexcept :
+        idx(0),
+        storage(nullptr)
+      {}
+
+      basic_variable_iterator(basic_variable_iterator const& other) noexcept :
+        idx(other.idx),
+        storage(other.storage)
+      {}
+
+      basic_variable_iterator& operator =(basic_variable_iterator const& other) noexcept {
+        if (&other == this) {
+          return *this;
+        }
+        idx = other.idx;
+        storage = other.storage;
+        return *this;
+      }
+
+      reference operator *() const noexcept {
+        return storage->reference_at(idx);
+      }
+
+      basic_variable_iterator& operator ++() noexcept {
+        ++idx;
+        return *this;
+      }
+
+      basic_variable_iterator& operator --() noexcept {
+        --idx;
+        return *this;
+      }
+
+      basic_variable_iterator operator ++(int) noexcept {
+        auto tmp {*this};
+        ++idx;
+        return tmp;
+      }
+
+      basic_variable_iterator operator --(int) noexcept {
+        auto tmp {*this};
+        --idx;
+        return tmp;
+      }
+
+      basic_variable_iterator& operator +=(difference_type offset) noexcept {
+        idx += offset;
+        return *this;
+      }
+
+      basic_variable_iterator& operator -=(difference_type offset) noexcept {
+        idx -= offset;
+        return *this;
+      }
+
+      reference operator [](difference_type offset) const noexcept {
+        return storage->reference_at(idx + offset);
+      }
+
+    private:
+
+      basic_variable_iterator(size_type idx, container_type const* storage) noexcept :
+        idx(idx),
+        storage(storage)
+      {}
+
+      friend Container;
+
+      size_type idx;
+      container_type const* storage;
+
+      friend bool operator ==(basic_variable_iterator const& lhs, basic_variable_iterator const& rhs) noexcept {
+        return lhs.idx == rhs.idx && lhs.storage == rhs.storage;
+      }
 
       friend bool operator !=(basic_variable_iterator const& lhs, basic_variable_iterator const& rhs) noexcept {
         return !(lhs == rhs);
       }
 
-      friend auto operator <=>(basic_variable_iterator const& lhs, basic_variable_iterator const& rhs) noexcept {
-        return lhs.idx <=> rhs.idx;
+      friend auto operator <=>(basic_variable_iterator const& lhs, basic_variable_iterator const& rhs) noexcept {
+        return lhs.idx <=> rhs.idx;
+      }
+
+      friend basic_variable_iterator operator -(basic_variable_iterator const& lhs, std::ptrdiff_t rhs) noexcept {
+        auto tmp {lhs};
+        auto tmpidx = lhs.idx - rhs;
+        tmp.idx = tmpidx;
+        return tmp;
+      }
+
+      friend basic_variable_iterator operator +(basic_variable_iterator const& lhs, std::ptrdiff_t rhs) noexcept {
+        auto tmp {lhs};
+        auto tmpidx = lhs.idx + rhs;
+        tmp.idx = tmpidx;
+        return tmp;
+      }
+
+      friend basic_variable_iterator operator +(std::ptrdiff_t lhs, basic_variable_iterator const& rhs) noexcept {
+        return rhs + lhs;
+      }
+
+      friend difference_type operator -(basic_variable_iterator const& lhs, basic_variable_iterator const& rhs) noexcept {
+        assert(lhs.storage == rhs.storage);
+        return static_cast<difference_type>(lhs.idx) - static_cast<difference_type>(rhs.idx);
+      }
+
+  };
+
+  template <template <class> class Storage,
+           template <class...> class Variant, meta::storable... Types>
+  class basic_variable_vector {
+
+    public:
+
+      using value_type = Variant<meta::copyable_type_for_t<Types>...>;
+      using size_type = size_t;
+      using difference_type = std::ptrdiff_t;
+      using reference = basic_variable_reference<Variant, Types...>;
+      using const_reference = reference;
+      using iterator = basic_variable_iterator<basic_variable_vector>;
+      using const_iterator = iterator;
+      using view_type = basic_variable_view<Variant, Types...>;
+
+      using logical_type = Variant<Types...>;
+      using storage_type = Storage<logical_type>;
+
+    private:
+
+      static constexpr bool nothrow_value_copyable =
+        std::is_nothrow_copy_constructible_v<value_type>;
+      static constexpr bool nothrow_logical_copyable =
+        std::is_nothrow_copy_constructible_v<logical_type>;
+
+      static constexpr bool nothrow_value_movable =
+        std::is_nothrow_move_constructible_v<value_type>;
+      static constexpr bool nothrow_logical_movable =
+        std::is_nothrow_move_constructible_v<logical_type>;
+
+      template <class T>
+      static constexpr bool contained_type_v = (std::is_same_v<T, Types> || ...);
+
+      template <class T>
+      static constexpr bool trivial_get_reqs_v =
+          contained_type_v<T> && std::is_trivially_constructible_v<T>;
+
+      template <class T>
+      static constexpr bool nontrivial_get_reqs_v =
+          contained_type_v<T> && !std::is_trivially_constructible_v<T>;
+
+      template <class Func>
+      static constexpr bool exhaustive_visitor_v = (std::is_invocable_v<Func, Types&> && ...);
+
+      template <class Func>
+      static constexpr bool nothrow_exhaustive_visitor_v = (std::is_nothrow_invocable_v<Func, Types&> && ...);
+
+      template <class T>
+      static constexpr bool nothrow_insertable_v =
+          storage_type::has_nothrow_resize && std::is_nothrow_constructible_v<logical_type, T>;
+
+      template <class T>
+      static constexpr bool variant_is_insertable_v =
+          nothrow_logical_movable && std::is_same_v<std::decay_t<T>, logical_type>;
+
+      template <class T>
+      static constexpr bool type_is_insertable_v = nothrow_logical_movable
+          && std::is_constructible_v<logical_type, T> && !std::is_same_v<std::decay_t<T>, logical_type>
+          && !std::is_same_v<std::decay_t<T>, reference>;
+
+      // The in-memory representation is position independent, and so can be shipped
+      // around as raw bytes, if every type is trivially copyable.
+      static constexpr bool trivially_serializable =
+          (std::is_trivially_copyable_v<Types> && ...) && storage_type::type_bits <= 8;
+
+    public:
+
+      basic_variable_vector()
+        noexcept(std::is_nothrow_constructible_v<storage_type>)
+      {}
+
+      explicit basic_variable_vector(size_type start_members) :
+        impl(start_members)
+      {}
+
+      // Constructors for allocator aware storage policies (varvec::pmr::vector).
+      explicit basic_variable_vector(std::pmr::memory_resource* resource)
+        requires std::is_constructible_v<storage_type, std::pmr::memory_resource*>
+      :
+        impl(resource)
+      {}
+
+      basic_variable_vector(size_type start_members, std::pmr::memory_resource* resource)
+        requires std::is_constructible_v<storage_type, size_type, std::pmr::memory_resource*>
+      :
+        impl(start_members, resource)
+      {}
+
+      // Constructor for file backed storage policies (varvec::mapped_vector).
+      explicit basic_variable_vector(std::filesystem::path const& path)
+        requires std::is_constructible_v<storage_type, std::filesystem::path const&>
+      :
+        impl(path)
+      {}
+
+      // Constructs a vector from any range of values that are convertible to the variant,
+      // including another varvec. See append_range.
+      template <std::ranges::input_range Range>
+      requires (
+        !std::is_same_v<std::remove_cvref_t<Range>, basic_variable_vector>
+        &&
+        std::is_constructible_v<logical_type, std::ranges::range_reference_t<Range>>
+      )
+      explicit basic_variable_vector(Range&& range) {
+        append_range(std::forward<Range>(range));
+      }
+
+      basic_variable_vector(basic_variable_vector const& other)
+        noexcept(nothrow_logical_copyable)
+        requires (std::copyable<Types> && ...)
+      :
+        impl(other.impl)
+      {}
+
+      basic_variable_vector(basic_variable_vector&& other)
+        noexcept(nothrow_logical_movable)
+      :
+        impl(std::move(other.impl))
+      {}
+
+      ~basic_variable_vector() = default;
+
+      // Subscript operator. Creates a temporary variant to return.
+      value_type operator [](size_type index) const noexcept(nothrow_value_copyable) {
+        assert(index < size());
+        uint8_t const type = impl.types[index];
+        auto const offset = impl.get_offset(index);
+        auto* const curr_ptr = impl.get_data() + offset;
+        return storage::get_aligned_ptr_for(type, curr_ptr, meta::identity<logical_type> {},
+            [] <class T> (T const* ptr) noexcept(nothrow_value_copyable) -> value_type {
+          if constexpr (std::copyable<T>) return *ptr;
+          else return ptr;
+        });
+      }
+
+      basic_variable_vector& operator =(basic_variable_vector const& other)
+        noexcept(std::is_nothrow_copy_assignable_v<storage_type>)
+        requires (std::copyable<Types> && ...)
+      {
+        if (&other == this) return *this;
+        impl = other.impl;
+        return *this;
+      }
+
+      basic_variable_vector& operator =(basic_variable_vector&& other)
+        noexcept(std::is_nothrow_move_assignable_v<storage_type>)
+      {
+        if (&other == this) return *this;
+        impl = std::move(other.impl);
+        return *this;
+      }
+
+      // Function handles forwarding in a std::variant of the right types.
+      template <class ValueType>
+      requires std::is_same_v<std::decay_t<ValueType>, logical_type>
+      void push_back(ValueType&& val)
+        noexcept(std::is_nothrow_constructible_v<std::decay_t<ValueType>, ValueType>)
+      {
+        std::visit([&] <class T> (T&& arg) {
+          emplace_back<std::decay_t<T>>(std::forward<T>(arg));
+        }, std::forward<ValueType>(val));
+      }
+
+      // Function copies in the member behind an iterator's proxy reference.
+      void push_back(reference const& val) requires (std::copyable<Types> && ...) {
+        val.visit([&] <class T> (T const& arg) { emplace_back<T>(arg); });
+      }
+
+      // Function handles forwarding in any type that's convertible to our variant type.
+      template <class ValueType>
+      requires (
+        std::is_constructible_v<logical_type, ValueType>
+        &&
+        !std::is_same_v<std::decay_t<ValueType>, logical_type>
+        &&
+        !std::is_same_v<std::decay_t<ValueType>, reference>
+      )
+      void push_back(ValueType&& val)
+        noexcept(
+          storage_type::has_nothrow_resize
+          &&
+          std::is_nothrow_constructible_v<logical_type, ValueType>
+        )
+      {
+        // XXX: It's REALLY difficult to get overload resolution here to work
+        // the way we'd want. This implementation is based on the converting constructor
+        // constraint rules added to the standard for std::variant in C++20.
+        // For details, check paper P0608R3.
+        using stored_type = meta::fuzzy_type_match_t<ValueType, Types...>;
+        emplace_back<stored_type>(std::forward<ValueType>(val));
+      }
+
+      // Function constructs a T from the given arguments directly in its packed slot
+      // at the end of the vector, without going through a temporary.
+      template <class T, class... Args>
+      requires contained_type_v<T> && std::is_constructible_v<T, Args...>
+      void emplace_back(Args&&... args)
+        noexcept(storage_type::has_nothrow_resize && std::is_nothrow_constructible_v<T, Args...>)
+      {
+        // Figure out where we'll store this thing, taking into account
+        // whether it needs to be aligned.
+        auto [data_ptr, alignment_bytes] = find_storage_base<T, false>(impl.offset);
+
+        // Check if we have it.
+        while (!impl.has_space(sizeof(T) + alignment_bytes) && data_ptr) {
+          // FIXME: Rethink grow strategy
+          // Static vector returns null on overflow if assertions are disabled. Will crash below.
+          // resize returns the end of the buffer, so we have to re-apply our alignment padding.
+          data_ptr = impl.resize(2);
+          if (data_ptr) data_ptr += alignment_bytes;
+        }
+
+        // Construct before touching any bookkeeping so a throwing constructor leaves us unchanged.
+        construct_at<T>(data_ptr, std::forward<Args>(args)...);
+
+        impl.incr_offset(alignment_bytes);
+        auto const curr_count = impl.count++;
+        impl.types[curr_count] = meta::index_of_v<T, Types...>;
+        impl.set_offset(curr_count, impl.offset);
+        impl.incr_offset(sizeof(T));
+      }
+
+      // Function appends every element of the given range.
+      //
+      // If the range can be traversed more than once, the exact footprint of the new elements
+      // is computed up front, so the storage grows at most once, and offsets are written without
+      // per-element width dispatch. Contiguous ranges of a trivially copyable member type are
+      // copied in with a single memcpy.
+      template <std::ranges::input_range Range>
+      requires std::is_constructible_v<logical_type, std::ranges::range_reference_t<Range>>
+      void append_range(Range&& range) {
+        using element_reference = std::ranges::range_reference_t<Range>;
+        using element_type = std::remove_cvref_t<element_reference>;
+
+        if constexpr (!std::ranges::forward_range<Range>) {
+          for (auto&& val : range) push_back(std::forward<decltype(val)>(val));
+        } else if constexpr (std::is_same_v<element_type, logical_type> || std::is_same_v<element_type, reference>) {
+          append_variants(range);
+        } else {
+          append_values<meta::fuzzy_type_match_t<element_reference, Types...>>(range);
+        }
+      }
+
+      // Function makes sure the vector can hold at least the given number of members,
+      // and bytes of data, without reallocating.
+      // Static vectors throw std::bad_alloc if asked for more than they can hold.
+      void reserve(size_type members, size_type bytes) {
+        impl.reserve(members, bytes);
+      }
+
+      // Function makes sure the given number of additional members of each of the given types
+      // can be added to the vector, in any order, without reallocating.
+      //
+      // Data capacity is sized from the exact footprint of the types, plus the worst case
+      // alignment padding the order could introduce, which is zero for trivially copyable types.
+      template <class... Ts, class... Counts>
+      requires (
+        sizeof...(Ts) == sizeof...(Counts)
+        &&
+        (contained_type_v<Ts> && ...)
+        &&
+        (std::is_convertible_v<Counts, size_type> && ...)
+      )
+      void reserve_for(Counts... counts) {
+        // Alignment that the non-trivial types force on the layout.
+        constexpr size_type alignment = std::max({size_type {1},
+            (std::is_trivially_copyable_v<Ts> ? size_type {1} : alignof(Ts))...});
+
+        size_type members = 0;
+        size_type bytes = 0;
+        size_type max_padding = 0;
+        size_type misaligners = 1;
+        ([&] (size_type count) {
+          members += count;
+          bytes += count * sizeof(Ts);
+          if constexpr (!std::is_trivially_copyable_v<Ts>) {
+            max_padding += count * (alignof(Ts) - 1);
+          } else if constexpr (sizeof(Ts) % alignment) {
+            // Only elements that leave the end misaligned can cause padding after them.
+            misaligners += count;
+          }
+        }(counts), ...);
+
+        auto const padding = std::min(max_padding, misaligners * (alignment - 1));
+        reserve(size() + members, impl.offset + bytes + padding);
+      }
+
+      // Number of bytes of data the vector can hold without reallocating.
+      size_type byte_capacity() const noexcept {
+        return impl.buffer_size();
+      }
+
+      // Function releases capacity beyond what the members currently use.
+      // Storage policies with fixed or inline capacity have nothing to release, and ignore it.
+      void shrink_to_fit() {
+        if constexpr (requires { impl.shrink_to_fit(); }) {
+          impl.shrink_to_fit();
+        }
+      }
+
+      // Function re-lays out every member into the minimal packed form that appending them
+      // in order would produce, reclaiming alignment padding left behind by inserts and erases.
+      // Returns the number of data bytes freed up for reuse, or, with shrink set, the number of
+      // bytes by which used_bytes() dropped after also shrinking the storage to fit.
+      size_type compact(bool shrink = false) requires nothrow_logical_movable {
+        auto const start_offset = impl.offset;
+        auto const start_bytes = used_bytes();
+        if (empty()) impl.offset = 0;
+        else compact_from(0, [] (size_type) { return true; });
+        if (!shrink) return start_offset - impl.offset;
+
+        shrink_to_fit();
+        return start_bytes - used_bytes();
+      }
+
+      // Function counts the members of the vector that are of type T.
+      // Works directly on the packed type tags, several words at a time.
+      template <class T>
+      requires contained_type_v<T>
+      size_type count_of() const noexcept {
+        constexpr uint8_t type = meta::index_of_v<T, Types...>;
+        if constexpr (storage_type::type_bits <= 8) {
+          return impl.types.count(type, size());
+        } else {
+          size_type matches = 0;
+          for (size_type i = 0; i < size(); ++i) matches += impl.types[i] == type;
+          return matches;
+        }
+      }
+
+      // Function returns the index of the first member of type T, or size() if there isn't one.
+      template <class T>
+      requires contained_type_v<T>
+      size_type find_first() const noexcept {
+        return find_next<T>(0);
+      }
+
+      // Function returns the index of the first member of type T at or after the given index,
+      // or size() if there isn't one.
+      template <class T>
+      requires contained_type_v<T>
+      size_type find_next(size_type from) const noexcept {
+        constexpr uint8_t type = meta::index_of_v<T, Types...>;
+        if constexpr (storage_type::type_bits <= 8) {
+          return impl.types.find(type, from, size());
+        } else {
+          while (from < size() && impl.types[from] != type) ++from;
+          return std::min(from, size());
+        }
+      }
+
+      // Function returns the indexes of every member of type T, in order.
+      template <class T>
+      requires contained_type_v<T>
+      std::vector<size_type> positions_of() const {
+        constexpr uint8_t type = meta::index_of_v<T, Types...>;
+        std::vector<size_type> positions;
+        if constexpr (storage_type::type_bits <= 8) {
+          impl.types.for_each_match(type, size(), [&] (size_type idx) { positions.push_back(idx); });
+        } else {
+          for (size_type i = 0; i < size(); ++i) {
+            if (impl.types[i] == type) positions.push_back(i);
+          }
+        }
+        return positions;
+      }
+
+      // Functions return a range over only the members of type T, which skips
+      // the other members by scanning the type tags rather than visiting them.
+      // Elements are yielded as references, except for trivially copyable types,
+      // which are yielded by value as they may be stored misaligned.
+      template <class T>
+      requires contained_type_v<T>
+      basic_typed_view<basic_variable_vector, T> view_of() noexcept {
+        return basic_typed_view<basic_variable_vector, T> {*this};
+      }
+
+      template <class T>
+      requires contained_type_v<T>
+      basic_typed_view<basic_variable_vector const, T> view_of() const noexcept {
+        return basic_typed_view<basic_variable_vector const, T> {*this};
+      }
+
+      // Function replaces the contents of the vector with the given range.
+      template <std::ranges::input_range Range>
+      requires std::is_constructible_v<logical_type, std::ranges::range_reference_t<Range>>
+      void assign(Range&& range) {
+        clear();
+        append_range(std::forward<Range>(range));
+      }
+
+      void pop_back() noexcept {
+        assert(!empty());
+        truncate(size() - 1);
+      }
+
+      // Function destroys every member from the given index on, and rewinds the end of the data
+      // to the end of the last surviving member, so the space can be reused.
+      // Capacity is kept, so a vector can be emptied and refilled without allocating.
+      void truncate(size_type count) noexcept {
+        if (count >= size()) return;
+
+        // Nothing to do per member if none of the types have destructors.
+        if constexpr (!std::is_trivially_destructible_v<logical_type>) {
+          for (auto idx = count; idx < size(); ++idx) destroy_at(idx);
+        }
+
+        auto& align_info = storage::alignment_map_for_v<value_type>;
+        impl.offset = count ? impl.get_offset(count - 1) + align_info[impl.types[count - 1]].size_of : 0;
+        impl.count = count;
+      }
+
+      void clear() noexcept {
+        truncate(0);
+      }
+
+      value_type front() const noexcept(nothrow_value_copyable) {
+        return (*this)[0];
+      }
+
+      value_type back() const noexcept(nothrow_value_copyable) {
+        return (*this)[size() - 1];
+      }
+
+      value_type at(size_t index) {
+        bounds_check(index);
+        return (*this)[index];
+      }
+
+      value_type at(size_t index) const {
+        bounds_check(index);
+        return (*this)[index];
+      }
+
+      // Function allows std::visit style visitation syntax at a given index.
+      // Useful because it's the only call that allows universal mutation.
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit(size_type index, Func&& callback)
+        noexcept(nothrow_exhaustive_visitor_v<Func>)
+      {
+        // Very carefully forwarding noexcept here because it seems to make a difference.
+        constexpr bool is_noexcept = noexcept(nothrow_exhaustive_visitor_v<Func>);
+
+        uint8_t const type = impl.types[index];
+        auto const offset = impl.get_offset(index);
+        auto* const curr_ptr = impl.get_data() + offset;
+        storage::get_aligned_ptr_for(type, curr_ptr,
+            meta::identity<logical_type> {}, [&] <class T> (T* ptr) noexcept(is_noexcept) {
+          std::forward<Func>(callback)(*ptr);
+        });
+      }
+
+      // Function allows std::visit style visitation syntax at a given index.
+      // Useful because it's the only call that allows universal mutation.
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit(size_type index, Func&& callback) const
+        noexcept(nothrow_exhaustive_visitor_v<Func>)
+      {
+        // Very carefully forwarding noexcept here because it seems to make a difference.
+        constexpr bool is_noexcept = noexcept(nothrow_exhaustive_visitor_v<Func>);
+
+        const_cast<basic_variable_vector*>(this)->visit(index, [&] <class T> (T& val) noexcept(is_noexcept) {
+          std::forward<Func>(callback)(const_cast<T const&>(val));
+        });
+      }
+
+      // Function allows std::visit style visitation syntax at a given index.
+      // Useful because it's the only call that allows universal mutation.
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit(iterator it, Func&& callback)
+        noexcept(nothrow_exhaustive_visitor_v<Func>)
+      {
+        visit(it.idx, std::forward<Func>(callback));
+      }
+
+      // Function allows std::visit style visitation syntax at a given index.
+      // Useful because it's the only call that allows universal mutation.
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit(iterator it, Func&& callback) const
+        noexcept(nothrow_exhaustive_visitor_v<Func>)
+      {
+        visit(it.idx, std::forward<Func>(callback));
+      }
+
+      // Function allows std::visit style visitation syntax at a given index.
+      // Useful because it's the only call that allows universal mutation.
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_at(size_type index, Func&& callback) {
+        bounds_check(index);
+        visit(index, std::forward<Func>(callback));
+      }
+
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_at(size_type index, Func&& callback) const {
+        const_cast<basic_variable_vector*>(this)->visit_at(index, [&] <class T> (T& val) {
+          std::forward<Func>(callback)(const_cast<T const&>(val));
+        });
+      }
+
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_at(iterator it, Func&& callback) {
+        visit_at(it.idx, std::forward<Func>(callback));
+      }
+
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_at(iterator it, Func&& callback) const {
+        visit_at(it.idx, std::forward<Func>(callback));
+      }
+
+      // Function visits every member in [first, last), in order.
+      // Unlike calling visit in a loop, the offset width is dispatched once for the whole range,
+      // and type tags are decoded a word at a time, so the loop body is just the type switch
+      // and the callback, which can be inlined into it.
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_range(size_type first, size_type last, Func&& callback)
+        noexcept(nothrow_exhaustive_visitor_v<Func>)
+      {
+        assert(first <= last && last <= size());
+
+        auto* const base = impl.get_data();
+        impl.with_offsets([&] (auto const* offs) noexcept(nothrow_exhaustive_visitor_v<Func>) {
+          auto visit_one = [&] (size_type idx, uint8_t type) noexcept(nothrow_exhaustive_visitor_v<Func>) {
+            storage::get_aligned_ptr_for(type, base + offs[idx],
+                meta::identity<logical_type> {}, [&] <class T> (T* ptr) noexcept(nothrow_exhaustive_visitor_v<Func>) {
+              callback(*ptr);
+            });
+          };
+
+          if constexpr (storage_type::type_bits <= 8) {
+            impl.types.for_each_entry(first, last, visit_one);
+          } else {
+            for (auto idx = first; idx < last; ++idx) visit_one(idx, impl.types[idx]);
+          }
+        });
+      }
+
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_range(size_type first, size_type last, Func&& callback) const
+        noexcept(nothrow_exhaustive_visitor_v<Func>)
+      {
+        const_cast<basic_variable_vector*>(this)->visit_range(first, last,
+            [&] <class T> (T& val) noexcept(nothrow_exhaustive_visitor_v<Func>) {
+          callback(const_cast<T const&>(val));
+        });
+      }
+
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_range(iterator first, iterator last, Func&& callback)
+        noexcept(nothrow_exhaustive_visitor_v<Func>)
+      {
+        visit_range(first.idx, last.idx, std::forward<Func>(callback));
+      }
+
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_range(iterator first, iterator last, Func&& callback) const
+        noexcept(nothrow_exhaustive_visitor_v<Func>)
+      {
+        visit_range(first.idx, last.idx, std::forward<Func>(callback));
+      }
+
+      // Function visits every member of the vector, in order.
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_all(Func&& callback) noexcept(nothrow_exhaustive_visitor_v<Func>) {
+        visit_range(0, size(), std::forward<Func>(callback));
+      }
+
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_all(Func&& callback) const noexcept(nothrow_exhaustive_visitor_v<Func>) {
+        visit_range(0, size(), std::forward<Func>(callback));
+      }
+
+      // Same as visit_all, but returns the callback like std::for_each,
+      // for callbacks that accumulate state.
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      Func for_each(Func callback) noexcept(nothrow_exhaustive_visitor_v<Func>) {
+        visit_all(callback);
+        return callback;
+      }
+
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      Func for_each(Func callback) const noexcept(nothrow_exhaustive_visitor_v<Func>) {
+        visit_all(callback);
+        return callback;
+      }
+
+      // Function visits every member, grouped by type rather than in order: every member
+      // of the first type in index order, then every member of the second, and so on.
+      // Each group is found by scanning the packed type tags, so the type switch runs once
+      // per type instead of once per member, and can't mispredict.
+      // Intended for reductions that don't care about order.
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_grouped(Func&& callback) {
+        (for_each_of_type<Types>([&] (uint8_t const* ptr) {
+          storage::get_aligned_ptr_for(0, const_cast<uint8_t*>(ptr),
+              meta::identity<Variant<Types>> {}, [&] (Types* val) { callback(*val); });
+        }), ...);
+      }
+
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_grouped(Func&& callback) const {
+        (for_each_of_type<Types>([&] (uint8_t const* ptr) {
+          storage::get_aligned_ptr_for(0, ptr,
+              meta::identity<Variant<Types>> {}, [&] (Types const* val) { callback(*val); });
+        }), ...);
+      }
+
+      // Like visit_grouped, but the callback receives each group as a series of
+      // homogeneous spans, which lets kernels like sums over std::span<int const> vectorize.
+      // Members of trivially copyable types are gathered into aligned chunks, so batches
+      // are dense even when types are interleaved.
+      template <class Func>
+      requires (std::is_invocable_v<Func&, std::span<Types>> && ...)
+      void visit_batched(Func&& callback) {
+        (batches_of<Types, true>(callback), ...);
+      }
+
+      template <class Func>
+      requires (std::is_invocable_v<Func&, std::span<Types const>> && ...)
+      void visit_batched(Func&& callback) const {
+        (batches_of<Types, false>(callback), ...);
+      }
+
+      template <class T>
+      requires nontrivial_get_reqs_v<T>
+      T& get(size_type index) & noexcept {
+        // Trust the user and grab it.
+        // Obviously this is UB if you call it with the wrong type
+        // If you want exceptions, call get_at.
+        return *reinterpret_cast<T*>(impl.get_data() + impl.get_offset(index));
+      }
+
+      template <class T>
+      requires nontrivial_get_reqs_v<T>
+      T const& get(size_type index) const& noexcept {
+        return const_cast<basic_variable_vector*>(this)->get<T>(index);
+      }
+
+      template <class T>
+      requires nontrivial_get_reqs_v<T>
+      T&& get(size_type index) && noexcept {
+        return std::move(get<T>());
+      }
+
+      template <class T>
+      requires nontrivial_get_reqs_v<T>
+      T& get(iterator it) & noexcept {
+        return get<T>(it.idx);
+      }
+
+      template <class T>
+      requires nontrivial_get_reqs_v<T>
+      T const& get(iterator it) const& noexcept {
+        return get<T>(it.idx);
+      }
+
+      template <class T>
+      requires nontrivial_get_reqs_v<T>
+      T&& get(iterator it) && noexcept {
+        return std::move(*this).template get<T>(it.idx);
+      }
+
+      template <class T>
+      requires trivial_get_reqs_v<T>
+      T get(size_type index) const noexcept {
+        // Trust the user and grab it.
+        // Obviously this is UB if you call it with the wrong type
+        // If you want exceptions, call get_at.
+        auto* const data_ptr = reinterpret_cast<T const*>(impl.get_data() + impl.get_offset(index));
+
+        // Since this overload is only for trivial types, the address
+        // could be misaligned, and so we copy into a temporary if so.
+        if (storage::aligned_for_type<T>(data_ptr)) {
+          return *data_ptr;
+        } else {
+          T retval;
+          memcpy(&retval, impl.get_data() + impl.get_offset(index), sizeof(T));
+          return retval;
+        }
+      }
+
+      template <class T>
+      requires trivial_get_reqs_v<T>
+      T get(iterator it) const noexcept {
+        return get<T>(it.idx);
+      }
+
+      template <class T>
+      requires nontrivial_get_reqs_v<T>
+      T& get_at(size_type index) & {
+        // Bounds and type checks.
+        bounds_check(index);
+        if (impl.types[index] != meta::index_of_v<T, Types...>) {
+          throw std::bad_cast();
+        }
+        return get<T>(index);
+      }
+
+      template <class T>
+      requires nontrivial_get_reqs_v<T>
+      T const& get_at(size_type index) const& {
+        return const_cast<basic_variable_vector*>(this)->get_at<T>(index);
+      }
+
+      template <class T>
+      requires nontrivial_get_reqs_v<T>
+      T&& get_at(size_type index) && {
+        return std::move(get_at<T>());
+      }
+
+      template <class T>
+      requires nontrivial_get_reqs_v<T>
+      T& get_at(iterator it) & {
+        return get_at<T>(it.idx);
+      }
+
+      template <class T>
+      requires nontrivial_get_reqs_v<T>
+      T const& get_at(iterator it) const& {
+        return get_at<T>(it.idx);
+      }
+
+      template <class T>
+      requires nontrivial_get_reqs_v<T>
+      T&& get_at(iterator it) && {
+        return std::move(*this).template get_at<T>(it.idx);
+      }
+
+      template <class T>
+      requires trivial_get_reqs_v<T>
+      T get_at(size_type index) const {
+        // Bounds and type checks.
+        bounds_check(index);
+        if (impl.types[index] != meta::index_of_v<T, Types...>) {
+          throw std::bad_cast();
+        }
+        return get<T>(index);
+      }
+
+      template <class T>
+      requires trivial_get_reqs_v<T>
+      T get_at(iterator it) const {
+        return get_at<T>(it.idx);
+      }
+
+      template <class ValueType>
+      requires variant_is_insertable_v<ValueType>
+      void insert(size_type idx, ValueType&& val)
+        noexcept(
+          storage_type::has_nothrow_resize
+          &&
+          std::is_nothrow_constructible_v<logical_type, ValueType>
+        )
+      {
+        std::visit([&] <class T> (T&& arg) {
+          emplace<std::decay_t<T>>(idx, std::forward<T>(arg));
+        }, std::forward<ValueType>(val));
+      }
+
+      template <class ValueType>
+      requires variant_is_insertable_v<ValueType>
+      void insert(iterator it, ValueType&& val) noexcept(nothrow_insertable_v<ValueType>) {
+        insert(it.idx, std::forward<ValueType>(val));
+      }
+
+      template <class ValueType>
+      requires type_is_insertable_v<ValueType>
+      void insert(size_type idx, ValueType&& val) noexcept(nothrow_insertable_v<ValueType>) {
+        using stored_type = meta::fuzzy_type_match_t<ValueType, Types...>;
+        emplace<stored_type>(idx, std::forward<ValueType>(val));
+      }
+
+      // Function constructs a T from the given arguments directly in its packed slot at the given index.
+      // If T's constructor can throw, the object is built in a temporary first, since by the time
+      // the slot exists, everything after it has already been shifted.
+      template <class T, class... Args>
+      requires nothrow_logical_movable && contained_type_v<T> && std::is_constructible_v<T, Args...>
+      void emplace(size_type idx, Args&&... args)
+        noexcept(storage_type::has_nothrow_resize && std::is_nothrow_constructible_v<T, Args...>)
+      {
+        assert(idx <= size());
+
+        // If this is equivalent to a push_back, just call that.
+        if (idx == size()) {
+          emplace_back<T>(std::forward<Args>(args)...);
+          return;
+        } else if constexpr (!std::is_nothrow_constructible_v<T, Args...>) {
+          T tmp(std::forward<Args>(args)...);
+          emplace<T>(idx, std::move(tmp));
+          return;
+        }
+
+        // Find the insert point and how much additional space we'll need
+        auto [additional_space, move_point] = find_insert_move_point<T>(idx);
+
+        // Make sure we have space.
+        // FIXME: Rethink grow strategy
+        // Static vector returns null on overflow if assertions are disabled.
+        while (!impl.has_space(additional_space) && impl.resize(2));
+
+        // Move everything forwards by the necessary offset, walking backwards from the end.
+        walk_backward_move_forward(idx, move_point);
+
+        // Perform the actual insert.
+        auto curr_offset = impl.get_offset(idx);
+        auto [insert_ptr, alignment_bytes] = find_storage_base<T, false>(curr_offset);
+        construct_at<T>(insert_ptr, std::forward<Args>(args)...);
+
+        // Update all bookkeeping
+        impl.types[idx] = meta::index_of_v<T, Types...>;
+        impl.set_offset(idx, curr_offset + alignment_bytes);
+        impl.incr_offset(additional_space);
+        ++impl.count;
+      }
+
+      template <class T, class... Args>
+      requires nothrow_logical_movable && contained_type_v<T> && std::is_constructible_v<T, Args...>
+      void emplace(iterator it, Args&&... args)
+        noexcept(storage_type::has_nothrow_resize && std::is_nothrow_constructible_v<T, Args...>)
+      {
+        emplace<T>(it.idx, std::forward<Args>(args)...);
+      }
+
+      template <class ValueType>
+      requires type_is_insertable_v<ValueType>
+      void insert(iterator it, ValueType&& val) noexcept(nothrow_insertable_v<ValueType>) {
+        insert(it.idx, std::forward<ValueType>(val));
+      }
+
+      // Function inserts every element of the given range before the given index.
+      //
+      // The footprint of the whole run is measured up front, so the storage grows at most once,
+      // and the tail is shifted once, by the full amount, rather than once per element.
+      // The new members are then constructed directly in the gap. If constructing them could
+      // throw, or the range can only be traversed once, the range is first collected into
+      // a temporary vector, and moved into the gap from there.
+      //
+      // The range must not refer to this vector.
+      template <std::ranges::input_range Range>
+      requires nothrow_logical_movable && std::is_constructible_v<logical_type, std::ranges::range_reference_t<Range>>
+      iterator insert_range(size_type idx, Range&& range) {
+        using element_reference = std::ranges::range_reference_t<Range>;
+        using element_type = std::remove_cvref_t<element_reference>;
+        assert(idx <= size());
+
+        if (idx == size()) {
+          append_range(std::forward<Range>(range));
+        } else if constexpr (std::is_same_v<element_type, reference>) {
+          if constexpr (std::ranges::forward_range<Range> && (std::is_nothrow_copy_constructible_v<Types> && ...)) {
+            insert_run(idx, [&] (auto&& sink) {
+              for (auto const& val : range) sink(val.index());
+            }, [&] (auto&& place) {
+              for (auto const& val : range) {
+                val.visit([&] <class T> (T const& arg) { construct_at<T>(place(val.index()), arg); });
+              }
+            });
+          } else {
+            insert_collected(idx, std::forward<Range>(range));
+          }
+        } else if constexpr (std::is_same_v<element_type, logical_type>) {
+          if constexpr (std::ranges::forward_range<Range> && std::is_nothrow_constructible_v<logical_type, element_reference>) {
+            insert_run(idx, [&] (auto&& sink) {
+              for (auto const& val : range) sink(val.index());
+            }, [&] (auto&& place) {
+              for (auto&& val : range) {
+                auto* const ptr = place(val.index());
+                std::visit([&] <class T> (T&& arg) {
+                  construct_at<std::decay_t<T>>(ptr, std::forward<T>(arg));
+                }, std::forward<decltype(val)>(val));
+              }
+            });
+          } else {
+            insert_collected(idx, std::forward<Range>(range));
+          }
+        } else {
+          using stored_type = meta::fuzzy_type_match_t<element_reference, Types...>;
+          constexpr uint8_t type = meta::index_of_v<stored_type, Types...>;
+          if constexpr (std::ranges::forward_range<Range> && std::is_nothrow_constructible_v<stored_type, element_reference>) {
+            insert_run(idx, [&] (auto&& sink) {
+              for (auto it = std::ranges::begin(range); it != std::ranges::end(range); ++it) sink(type);
+            }, [&] (auto&& place) {
+              for (auto&& val : range) construct_at<stored_type>(place(type), std::forward<decltype(val)>(val));
+            });
+          } else {
+            insert_collected(idx, std::forward<Range>(range));
+          }
+        }
+        return begin() + idx;
+      }
+
+      template <std::ranges::input_range Range>
+      requires nothrow_logical_movable && std::is_constructible_v<logical_type, std::ranges::range_reference_t<Range>>
+      iterator insert_range(iterator it, Range&& range) {
+        return insert_range(it.idx, std::forward<Range>(range));
+      }
+
+      template <std::input_iterator It, std::sentinel_for<It> Sentinel>
+      requires nothrow_logical_movable && std::is_constructible_v<logical_type, std::iter_reference_t<It>>
+      iterator insert_range(size_type idx, It first, Sentinel last) {
+        return insert_range(idx, std::ranges::subrange(std::move(first), std::move(last)));
+      }
+
+      iterator erase(size_type idx) noexcept requires nothrow_logical_movable {
+        assert(idx < size());
+
+        // Knock out the requested index and shift everything backwards
+        return erase(idx, idx + 1);
+      }
+
+      iterator erase(iterator it) noexcept requires nothrow_logical_movable {
+        return erase(it.idx);
+      }
+
+      // Function erases every member in [first, last), destroying them and then sliding
+      // the rest down in a single pass, rather than shifting the tail once per member.
+      iterator erase(size_type first, size_type last) noexcept requires nothrow_logical_movable {
+        assert(first <= last && last <= size());
+        if (first != last) compact_from(first, [&] (size_type idx) { return idx >= last; });
+        return begin() + first;
+      }
+
+      iterator erase(iterator first, iterator last) noexcept requires nothrow_logical_movable {
+        return erase(first.idx, last.idx);
+      }
+
+      // Function erases every member for which the predicate returns true, and returns how many
+      // it erased. The predicate is called with each member, in order, by const reference.
+      // Unlike std::remove_if, survivors are compacted and the vector resized in the same pass,
+      // so every member is moved at most once, and type tags and offsets are rewritten once.
+      //
+      // If the predicate throws, the members it hasn't been asked about yet are kept,
+      // and the vector is left compacted up to that point.
+      template <class Pred>
+      requires nothrow_logical_movable && (std::is_invocable_r_v<bool, Pred&, Types const&> && ...)
+      size_type remove_if(Pred pred) {
+        auto const start_size = size();
+        std::exception_ptr error;
+        compact_from(0, [&] (size_type idx) {
+          if (error) return true;
+          try {
+            auto const* const curr_ptr = std::as_const(impl).get_data() + impl.get_offset(idx);
+            return !storage::get_aligned_ptr_for(impl.types[idx], curr_ptr,
+                meta::identity<logical_type> {}, [&] <class T> (T const* val) -> bool {
+              return pred(*val);
+            });
+          } catch (...) {
+            error = std::current_exception();
+            return true;
+          }
+        });
+        if (error) std::rethrow_exception(error);
+        return start_size - size();
+      }
+
+      size_type size() const noexcept {
+        return impl.count;
+      }
+
+      size_type capacity() const noexcept {
+        return impl.max_members();
+      }
+
+      bool empty() const noexcept {
+        return size() == 0;
+      }
+
+      template <class ValueType>
+      requires std::is_same_v<std::decay_t<ValueType>, logical_type>
+      bool has_space(ValueType const& val) const noexcept {
+        return std::visit([&] (auto& arg) { return has_space(arg); });
+      }
+
+      template <class ValueType>
+      requires (
+          std::is_constructible_v<logical_type, ValueType>
+          &&
+          !std::is_same_v<std::decay_t<ValueType>, logical_type>
+          &&
+          !std::is_same_v<std::decay_t<ValueType>, reference>
+      )
+      bool has_space(ValueType const&) const noexcept {
+        // Compute the type we would store for this argument
+        return has_space_for<meta::fuzzy_type_match_t<ValueType, Types...>>();
+      }
+
+      // Function checks whether a T could be appended without growing the storage.
+      template <class T>
+      requires contained_type_v<T>
+      bool has_space_for() const noexcept {
+        // Figure out if we need space for alignment
+        auto [_, alignment_bytes] = find_storage_base<T>(impl.offset);
+
+        // Check if we have it.
+        return impl.has_space(sizeof(T) + alignment_bytes);
+      }
+
+      size_type used_bytes() const noexcept {
+        return impl.size();
+      }
+
+      // Function computes the number of bytes serialize will write.
+      size_type serialized_size() const noexcept requires trivially_serializable {
+        return impl.with_offsets([&] <class O> (O const*) {
+          return serialization::layout {storage_type::type_bits, sizeof(O), size(), impl.offset}.total_bytes();
+        });
+      }
+
+      // Function writes the vector into the given buffer in a versioned binary format,
+      // returning the number of bytes written.
+      // The format is [header | types | offsets | data], and can be read back by from_bytes.
+      size_type serialize(std::span<std::byte> buffer) const requires trivially_serializable {
+        auto const required = serialized_size();
+        if (buffer.size() < required) {
+          std::string msg = "varvec::vector was serialized into a buffer that was too small. ";
+          msg += "Required: " + std::to_string(required);
+          msg += ", size was: " + std::to_string(buffer.size());
+          throw std::length_error(msg);
+        }
+
+        auto* const base = reinterpret_cast<uint8_t*>(buffer.data());
+        impl.with_offsets([&] <class O> (O const* offs) {
+          serialization::layout const layout {storage_type::type_bits, sizeof(O), size(), impl.offset};
+          serialization::header const head {
+            serialization::magic,
+            serialization::current_version,
+            std::endian::native == std::endian::little,
+            sizeof(O),
+            serialization::signature_v<logical_type>,
+            size(),
+            impl.offset
+          };
+
+          // Zero everything first so that alignment padding is deterministic.
+          memset(base, 0, layout.total_bytes());
+          memcpy(base, &head, sizeof(head));
+          memcpy(base + layout.types_begin(), impl.types.data(), impl.types.bytes_for(size()));
+          memcpy(base + layout.offsets_begin(), offs, size() * sizeof(O));
+          memcpy(base + layout.data_begin(), impl.get_data(), impl.offset);
+        });
+        return required;
+      }
+
+      std::vector<std::byte> to_bytes() const requires trivially_serializable {
+        std::vector<std::byte> bytes(serialized_size());
+        serialize(bytes);
+        return bytes;
+      }
+
+      // Function reconstructs a vector from a buffer previously written by serialize.
+      // Throws std::invalid_argument if the buffer is malformed, or was written by a vector
+      // with a different type list. Individual type tags and offsets are trusted, not validated.
+      static basic_variable_vector from_bytes(std::span<std::byte const> bytes)
+        requires trivially_serializable
+      {
+        auto const head = serialization::read_header<logical_type>(bytes, storage_type::type_bits);
+        serialization::layout const layout {
+          storage_type::type_bits,
+          head.offset_width,
+          head.count,
+          head.data_bytes
+        };
+        auto const* const base = reinterpret_cast<uint8_t const*>(bytes.data());
+
+        basic_variable_vector vec;
+        auto& impl = vec.impl;
+        impl.reserve(head.count, head.data_bytes);
+
+        // Make sure the offset storage is wide enough for every offset we're about to write.
+        if (head.count) impl.set_offset(0, head.data_bytes);
+        impl.with_offsets([&] <class T> (T* offs) {
+          auto const* const src = base + layout.offsets_begin();
+          if (sizeof(T) == head.offset_width) {
+            memcpy(offs, src, head.count * sizeof(T));
+          } else {
+            // Serialized with a different offset width, have to convert one by one.
+            storage::offsets::dispatch_width(head.offset_width, [&] <class O> (meta::identity<O>) {
+              for (size_type i = 0; i < head.count; ++i) {
+                O tmp;
+                memcpy(&tmp, src + i * sizeof(O), sizeof(O));
+                offs[i] = static_cast<T>(tmp);
+              }
+            });
+          }
+        });
+        memcpy(impl.types.data(), base + layout.types_begin(), impl.types.bytes_for(head.count));
+        memcpy(impl.get_data(), base + layout.data_begin(), head.data_bytes);
+        impl.count = head.count;
+        impl.offset = head.data_bytes;
+        return vec;
+      }
+
+      // Function flushes the vector to its backing file, for storage policies that have one.
+      void sync() requires requires (storage_type& storage) { storage.sync(); } {
+        impl.sync();
+      }
+
+      // Function returns a non-owning, read-only view of the vector.
+      // The view is invalidated by anything that would invalidate an iterator.
+      view_type view() const noexcept requires (storage_type::type_bits <= 8) {
+        return impl.with_offsets([&] <class O> (O const* offs) {
+          return view_type {
+            impl.types.data(),
+            reinterpret_cast<uint8_t const*>(offs),
+            sizeof(O),
+            impl.get_data(),
+            size(),
+            impl.offset
+          };
+        });
+      }
+
+      iterator begin() const noexcept {
+        return iterator {0, this};
+      }
+
+      iterator end() const noexcept {
+        return iterator {size(), this};
+      }
+
+    private:
+
+      friend iterator;
+
+      reference reference_at(size_type index) const noexcept {
+        return reference {impl.types[index], impl.get_data() + impl.get_offset(index)};
+      }
+
+      template <class ValueType, bool is_const = true>
+      auto find_storage_base(size_type offset) const noexcept {
+        auto* const base_ptr = impl.get_data() + offset;
+        auto* data_ptr = base_ptr;
+
+        // Figure out how much space we'll need.
+        auto const required_bytes = sizeof(ValueType);
+        if constexpr (!std::is_trivially_copyable_v<ValueType>) {
+          data_ptr = storage::realign_for_type<ValueType>(data_ptr);
+        }
+        auto const alignment_bytes = data_ptr - base_ptr;
+
+        if constexpr (is_const) {
+          return std::tuple {data_ptr, alignment_bytes};
+        } else {
+          return std::tuple {const_cast<uint8_t*>(data_ptr), alignment_bytes};
+        }
+      }
+
+      template <class InsertType>
+      auto find_insert_move_point(size_type index) const noexcept {
+        // Pre-compute all metadata for the type we're inserting
+        uint8_t prev_type_of = meta::index_of_v<InsertType, Types...>;
+        auto& align_info = storage::alignment_map_for_v<value_type>;
+        auto prev = align_info[prev_type_of];
+
+        // Walk index by index and compute how much space we'll need to perform the insert.
+        auto curr_idx = index;
+        auto curr_offset = impl.get_offset(curr_idx);
+        while (curr_idx <= size()) {
+          // Prospective address of the current index.
+          auto* const curr_ptr = impl.get_data() + curr_offset;
+
+          // If the previous storage index were to be relocated based on this pointer,
+          // would it also need to be realigned?
+          if (prev.needs_align) {
+            auto* const aligned_ptr =
+                storage::realign_for_type_index<value_type>(curr_ptr, prev_type_of);
+            curr_offset += aligned_ptr - curr_ptr;
+          }
+          curr_offset += prev.size_of;
+
+          // Update
+          if (curr_idx < size()) {
+            prev_type_of = impl.types[curr_idx];
+            prev = align_info[prev_type_of];
+          }
+          ++curr_idx;
+        }
+
+        // curr_offset is now pushed all the way to the end of the bytes needed for the insert.
+        // From this, compute the first destination address for the move routine (offset minus size
+        // of final element), along with the number of additional bytes we'll need to use in total.
+        auto move_point = curr_offset - align_info[impl.types[size() - 1]].size_of;
+        return std::tuple {curr_offset - impl.offset, move_point};
+      }
+
+      void walk_backward_move_forward(size_type insert_index, size_type move_point, size_type shift = 1) noexcept {
+        static_assert(nothrow_logical_movable);
+
+        auto curr_idx = size();
+        auto* const base = impl.get_data();
+        auto& align_info = storage::alignment_map_for_v<value_type>;
+        do {
+          // do-while and start with decrement
+          // to handle counting down to zero with an unsigned type.
+          --curr_idx;
+
+          // Get current metadata
+          uint8_t const type_index = impl.types[curr_idx];
+          auto const& curr = align_info[type_index];
+          auto const src_offset = impl.get_offset(curr_idx);
+
+          if (curr.needs_align) {
+            // Compute from/to
+            uint8_t* const move_dst = base + move_point;
+            uint8_t* const move_src = base + src_offset;
+
+            // Sanity checks
+            assert(storage::aligned_for_type_index<value_type>(move_src, type_index));
+            assert(storage::aligned_for_type_index<value_type>(move_dst, type_index));
+
+            // Handles carefully calling a move constructor on pointers that may overlap.
+            if (move_src != move_dst) move_overlapping_pointers(curr, move_src, move_dst, type_index);
+
+            // Update type and offset
+            impl.types[curr_idx + shift] = type_index;
+            impl.set_offset(curr_idx + shift, move_point);
+          } else {
+            // Trivially copyable members are packed without padding, so collect the whole run
+            // of them that ends here and shift it with a single memmove.
+            auto first = curr_idx;
+            auto run_start = src_offset;
+            while (first > insert_index) {
+              auto const& prev = align_info[impl.types[first - 1]];
+              auto const prev_offset = impl.get_offset(first - 1);
+              if (prev.needs_align || prev_offset + prev.size_of != run_start) break;
+              run_start = prev_offset;
+              --first;
+            }
+
+            // Regions can overlap, so we can't memcpy
+            auto const delta = move_point - src_offset;
+            if (delta) memmove(base + run_start + delta, base + run_start, src_offset + curr.size_of - run_start);
+
+            // Walk backwards so nothing is overwritten before it's read.
+            for (auto i = curr_idx + 1; i-- > first;) {
+              impl.types[i + shift] = static_cast<uint8_t>(impl.types[i]);
+              impl.set_offset(i + shift, impl.get_offset(i) + delta);
+            }
+            curr_idx = first;
+            move_point = run_start + delta;
+          }
+
+          // Compute next move target
+          if (curr_idx > insert_index) {
+            // Get the type of the next thing to be moved.
+            uint8_t const next_type = impl.types[curr_idx - 1];
+            auto const& next = align_info[next_type];
+
+            // Compute the offset for the next object
+            uint8_t* next_dst;
+            if (next.needs_align) {
+              next_dst = storage::realign_backwards_for(base + move_point - next.size_of, next.align_of);
+            } else {
+              next_dst = base + move_point - next.size_of;
+            }
+            move_point = next_dst - base;
+          }
+        } while (curr_idx != insert_index);
+      }
+
+      // Function opens a gap before the given index for a run of new members, and fills it.
+      // measure is called with a sink that it has to call with the type index of each new
+      // member, in order. fill is then called with a function that, for each new member in the
+      // same order, takes its type index, records it, and returns the address to construct it at.
+      //
+      // Only measuring and making room can throw, so fill has to be noexcept.
+      template <class Measure, class Fill>
+      void insert_run(size_type idx, Measure&& measure, Fill&& fill) {
+        assert(idx < size());
+        auto& align_info = storage::alignment_map_for_v<value_type>;
+        auto advance = [&] (size_type& cursor, uint8_t type) {
+          auto const& info = align_info[type];
+          if (info.needs_align) cursor = align_offset(cursor, info.align_of);
+          cursor += info.size_of;
+        };
+
+        // Lay out the run, followed by the tail, to find the new end.
+        auto const start = impl.get_offset(idx);
+        auto cursor = start;
+        size_type members = 0;
+        measure([&] (uint8_t type) {
+          advance(cursor, type);
+          ++members;
+        });
+        if (!members) return;
+        for (auto i = idx; i < size(); ++i) advance(cursor, impl.types[i]);
+        auto const end = cursor;
+
+        // Everything that can fail happens before anything is moved.
+        reserve_for_append(members, end - align_info[impl.types[size() - 1]].size_of, end);
+
+        // Shift the tail once, packed against the new end.
+        walk_backward_move_forward(idx, end - align_info[impl.types[size() - 1]].size_of, members);
+
+        // And construct the run in the gap.
+        auto curr_idx = idx;
+        cursor = start;
+        fill([&] (uint8_t type) {
+          auto const& info = align_info[type];
+          if (info.needs_align) cursor = align_offset(cursor, info.align_of);
+          auto* const ptr = impl.get_data() + cursor;
+          impl.types[curr_idx] = type;
+          impl.set_offset(curr_idx++, cursor);
+          cursor += info.size_of;
+          return ptr;
+        });
+        assert(curr_idx == idx + members);
+        impl.count += members;
+        impl.offset = end;
+      }
+
+      // Fallback for insert_range when the new members can't be constructed in place.
+      template <class Range>
+      void insert_collected(size_type idx, Range&& range) {
+        basic_variable_vector tmp;
+        tmp.append_range(std::forward<Range>(range));
+        insert_run(idx, [&] (auto&& sink) {
+          for (size_type i = 0; i < tmp.size(); ++i) sink(tmp.impl.types[i]);
+        }, [&] (auto&& place) {
+          for (size_type i = 0; i < tmp.size(); ++i) {
+            auto* const ptr = place(tmp.impl.types[i]);
+            tmp.visit(i, [&] <class T> (T& val) noexcept { construct_at<T>(ptr, std::move(val)); });
+          }
+        });
+      }
+
+      // Function walks forward from the given index, destroying every member the callback
+      // doesn't want to keep, and moving each kept member back into the first free slot.
+      // Survivors are only moved once, and the vector is shrunk at the end.
+      template <class Keep>
+      void compact_from(size_type from, Keep&& keep) noexcept {
+        if (from >= size()) return;
+
+        auto& align_info = storage::alignment_map_for_v<value_type>;
+        auto* const base = impl.get_data();
+        auto dst_idx = from;
+        auto dst_offset = impl.get_offset(from);
+
+        // Consecutive trivially copyable survivors are contiguous on both sides of the move,
+        // so they're collected into a run and shifted with a single memmove.
+        // The run has to be flushed before anything else is moved, as the destination of
+        // the next move may overlap bytes of the run that haven't moved yet.
+        size_type run_src = 0, run_dst = 0, run_bytes = 0;
+        auto flush = [&] {
+          if (run_bytes && run_src != run_dst) memmove(base + run_dst, base + run_src, run_bytes);
+          run_bytes = 0;
+        };
+
+        for (auto src_idx = from; src_idx < size(); ++src_idx) {
+          if (!keep(src_idx)) {
+            destroy_at(src_idx);
+            continue;
+          }
+
+          // Get type and alignment info for the index we're moving
+          uint8_t const type_index = impl.types[src_idx];
+          auto const& curr = align_info[type_index];
+          auto const src_offset = impl.get_offset(src_idx);
+
+          if (!curr.needs_align) {
+            if (src_offset != run_src + run_bytes || !run_bytes) {
+              flush();
+              run_src = src_offset;
+              run_dst = dst_offset;
+            }
+            run_bytes += curr.size_of;
+            impl.types[dst_idx] = type_index;
+            impl.set_offset(dst_idx++, dst_offset);
+            dst_offset += curr.size_of;
+            continue;
+          }
+          flush();
+
+          // Compute the new storage location
+          auto* const move_dst = storage::realign_for_type_index<value_type>(base + dst_offset, type_index);
+          auto* const move_src = base + src_offset;
+          if (move_src != move_dst) move_overlapping_pointers(curr, move_src, move_dst, type_index);
+
+          // Update bookkeeping
+          impl.types[dst_idx] = type_index;
+          impl.set_offset(dst_idx, move_dst - base);
+          dst_offset = (move_dst - base) + curr.size_of;
+          ++dst_idx;
+        }
+        flush();
+        impl.count = dst_idx;
+        impl.offset = dst_offset;
+      }
+
+      void move_overlapping_pointers(auto const& align,
+          uint8_t* move_src, uint8_t* move_dst, uint8_t type_index) noexcept
+        requires nothrow_logical_movable
+      {
+        storage::get_typed_ptr_for(type_index, move_src,
+            meta::identity<logical_type> {}, [&] <class T> (T* srcptr) noexcept {
+          static_assert(!std::is_const_v<T>);
+
+          // XXX: Have to be very careful here.
+          //
+          // The move_src and move_dst can potentially overlap in memory, and if they do
+          // we have to move through an intermediate object to prevent accidentally corrupting
+          // the object while we move from it.
+          //
+          // The check is formulated as it is so it'll work regardless of which is first in memory.
+          auto const srcintptr = reinterpret_cast<std::uintptr_t>(srcptr);
+          auto const destintptr = reinterpret_cast<std::uintptr_t>(move_dst);
+          if (std::max(srcintptr, destintptr) <
+              std::min(srcintptr + align.size_of, destintptr + align.size_of)) {
+            T tmp(std::move(*srcptr));
+            srcptr->~T();
+
+            // We call placement-new here on an untyped pointer.
+            // The idea is hopefully encourage the compiler to realize that it might alias
+            new(move_dst) T(std::move(tmp));
+          } else {
+            new(move_dst) T(std::move(*srcptr));
+            srcptr->~T();
+          }
+        });
+      }
+
+      static constexpr size_type align_offset(size_type offset, size_type alignment) noexcept {
+        return (offset + alignment - 1) & ~(alignment - 1);
+      }
+
+      // Function makes room for the given number of additional members ending at the given offset,
+      // including making sure the offset storage is wide enough to represent it.
+      void reserve_for_append(size_type members, size_type last_offset, size_type end_offset) {
+        impl.reserve(size() + members, end_offset);
+        impl.set_offset(size() + members - 1, last_offset);
+      }
+
+      // Appends a forward range of values that all map to the same member type.
+      template <class T, class Range>
+      void append_values(Range& range) {
+        size_type const members = std::ranges::distance(range);
+        if (!members) return;
+
+        // Every element has the same footprint, so the layout is known without a pass.
+        auto const begin = std::is_trivially_copyable_v<T> ? impl.offset : align_offset(impl.offset, alignof(T));
+        auto const end = begin + members * sizeof(T);
+        reserve_for_append(members, end - sizeof(T), end);
+
+        constexpr uint8_t type = meta::index_of_v<T, Types...>;
+        using element_type = std::remove_cvref_t<std::ranges::range_reference_t<Range>>;
+        if constexpr (std::ranges::contiguous_range<Range>
+            && std::is_same_v<element_type, T> && std::is_trivially_copyable_v<T>) {
+          memcpy(impl.get_data() + begin, std::ranges::data(range), members * sizeof(T));
+          impl.with_offsets([&] <class O> (O* offs) {
+            for (size_type i = 0; i < members; ++i) {
+              offs[impl.count] = static_cast<O>(begin + i * sizeof(T));
+              impl.types[impl.count++] = type;
+            }
+          });
+          impl.offset = end;
+        } else {
+          // Bookkeeping is updated element by element, so that if a constructor throws,
+          // everything constructed up to that point is still owned by the vector.
+          impl.incr_offset(begin - impl.offset);
+          impl.with_offsets([&] <class O> (O* offs) {
+            for (auto&& val : range) {
+              construct_at<T>(impl.get_data() + impl.offset, std::forward<decltype(val)>(val));
+              offs[impl.count] = static_cast<O>(impl.offset);
+              impl.types[impl.count++] = type;
+              impl.incr_offset(sizeof(T));
+            }
+          });
+        }
+      }
+
+      // Appends a forward range of variants, or of proxy references from another vector,
+      // which is measured in one pass and written in another.
+      template <class Range>
+      void append_variants(Range& range) {
+        auto& align_info = storage::alignment_map_for_v<logical_type>;
+
+        size_type members = 0;
+        size_type curr = impl.offset;
+        size_type last = curr;
+        for (auto const& val : range) {
+          auto const& info = align_info[val.index()];
+          if (info.needs_align) curr = align_offset(curr, info.align_of);
+          last = curr;
+          curr += info.size_of;
+          ++members;
+        }
+        if (!members) return;
+        reserve_for_append(members, last, curr);
+
+        impl.with_offsets([&] <class O> (O* offs) {
+          for (auto&& val : range) {
+            uint8_t const type = val.index();
+            auto const& info = align_info[type];
+            if (info.needs_align) impl.offset = align_offset(impl.offset, info.align_of);
+
+            auto construct = [&] <class T> (T&& arg) {
+              construct_at<std::decay_t<T>>(impl.get_data() + impl.offset, std::forward<T>(arg));
+            };
+            if constexpr (std::is_same_v<std::remove_cvref_t<decltype(val)>, reference>) val.visit(construct);
+            else std::visit(construct, std::forward<decltype(val)>(val));
+            offs[impl.count] = static_cast<O>(impl.offset);
+            impl.types[impl.count++] = type;
+            impl.incr_offset(info.size_of);
+          }
+        });
+      }
+
+      // Function invokes the callback with the address of every member of type T, in order.
+      template <class T, class Func>
+      void for_each_of_type(Func&& callback) const {
+        constexpr uint8_t type = meta::index_of_v<T, Types...>;
+        auto const* const base = impl.get_data();
+        impl.with_offsets([&] (auto const* offs) {
+          if constexpr (storage_type::type_bits <= 8) {
+            impl.types.for_each_match(type, size(), [&] (size_type idx) { callback(base + offs[idx]); });
+          } else {
+            for (size_type idx = 0; idx < size(); ++idx) {
+              if (impl.types[idx] == type) callback(base + offs[idx]);
+            }
+          }
+        });
+      }
+
+      // Function hands every member of type T to a batch callback, as spans.
+      // Trivially copyable types may be stored misaligned, and are usually scattered between
+      // members of other types, so they're gathered into an aligned buffer a chunk at a time
+      // (and scattered back afterwards, if the callback is allowed to mutate them).
+      // Other types are always aligned, and are passed in place, a span per run of members
+      // that sit back to back.
+      template <class T, bool mutate, class Func>
+      void batches_of(Func& callback) const {
+        using value = std::conditional_t<mutate, T, T const>;
+
+        if constexpr (std::is_trivially_copyable_v<T>) {
+          constexpr size_type chunk = std::max<size_type>(1, 1024 / sizeof(T));
+          alignas(T) std::byte buf[chunk * sizeof(T)];
+          uint8_t const* ptrs[mutate ? chunk : 1];
+          size_type len = 0;
+
+          auto flush = [&] {
+            callback(std::span<value> {std::launder(reinterpret_cast<value*>(buf)), len});
+            if constexpr (mutate) {
+              for (size_type i = 0; i < len; ++i) {
+                memcpy(const_cast<uint8_t*>(ptrs[i]), buf + i * sizeof(T), sizeof(T));
+              }
+            }
+            len = 0;
+          };
+          for_each_of_type<T>([&] (uint8_t const* ptr) {
+            memcpy(buf + len * sizeof(T), ptr, sizeof(T));
+            if constexpr (mutate) ptrs[len] = ptr;
+            if (++len == chunk) flush();
+          });
+          if (len) flush();
+        } else {
+          uint8_t const* run = nullptr;
+          size_type len = 0;
+          auto flush = [&] {
+            assert(storage::aligned_for_type<T>(run));
+            callback(std::span<value> {reinterpret_cast<value*>(const_cast<uint8_t*>(run)), len});
+          };
+          for_each_of_type<T>([&] (uint8_t const* ptr) {
+            if (len && ptr == run + len * sizeof(T)) {
+              ++len;
+              return;
+            }
+            if (len) flush();
+            run = ptr;
+            len = 1;
+          });
+          if (len) flush();
+        }
+      }
+
+      // Function constructs a T at a location returned by find_storage_base.
+      template <class T, class... Args>
+      static void construct_at(uint8_t* ptr, Args&&... args)
+        noexcept(std::is_nothrow_constructible_v<T, Args...>)
+      {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+          // May copy to a misaligned address
+          // If you crash here you overflowed a static vector.
+          T const tmp(std::forward<Args>(args)...);
+          memcpy(ptr, &tmp, sizeof(T));
+        } else {
+          // Will align at native requirements
+          // If you crash here you overflowed a static vector.
+          new(ptr) T(std::forward<Args>(args)...);
+        }
+      }
+
+      void destroy_at(size_type index) noexcept {
+        uint8_t const type = impl.types[index];
+        auto const offset = impl.get_offset(index);
+        auto* const curr_ptr = impl.get_data() + offset;
+        storage::get_aligned_ptr_for(type, curr_ptr,
+            meta::identity<logical_type> {}, [] <class T> (T* ptr) noexcept {
+          ptr->~T();
+        });
       }
 
-      friend basic_variable_iterator operator -(basic_variable_iterator const& lhs, std::ptrdiff_t rhs) noexcept {
-        auto tmp {lhs};
-        auto tmpidx = lhs.idx - rhs;
-        tmp.idx = tmpidx;
-        return tmp;
+      void bounds_check(size_t index) const {
+        if (index >= size()) {
+          std::string msg = "varvec::vector was indexed out of bounds. ";
+          msg += "Index was: " + std::to_string(index);
+          msg += ", size was: " + std::to_string(size());
+          throw std::out_of_range(msg);
+        }
       }
 
-      friend basic_variable_iterator operator +(basic_variable_iterator const& lhs, std::ptrdiff_t rhs) noexcept {
-        auto tmp {lhs};
-        auto tmpidx = lhs.idx + rhs;
-        tmp.idx = tmpidx;
-        return tmp;
-      }
+      storage_type impl;
 
-      friend basic_variable_iterator operator +(std::ptrdiff_t lhs, basic_variable_iterator const& rhs) noexcept {
-        return rhs + lhs;
+      // FIXME: We can do better performance wise
+      friend bool operator ==(basic_variable_vector const& lhs, basic_variable_vector const& rhs)
+        noexcept(noexcept(*lhs.begin() != *rhs.begin()))
+      {
+        auto lhs_it = lhs.begin();
+        auto rhs_it = rhs.begin();
+        while (lhs_it != lhs.end() && rhs_it != rhs.end()) {
+          if (*lhs_it++ != *rhs_it++) return false;
+        }
+        return lhs_it == lhs.end() && rhs_it == rhs.end();
       }
 
   };
 
-  template <template <class> class Storage,
-           template <class...> class Variant, meta::storable... Types>
-  class basic_variable_vector {
+  // Class implements the read-only half of the basic_variable_vector interface
+  // over a packed representation that somebody else owns.
+  //
+  // The region is expected to be laid out the same way as the vector storage policies
+  // lay it out (packed type tags, an offset table of 1, 2, 4, or 8 byte integers,
+  // and the data itself), and can either come from a live vector, or from a buffer
+  // written by basic_variable_vector::serialize. The latter means a memory mapped file
+  // can be queried in place, without parsing, copying, or allocating.
+  template <template <class...> class Variant, meta::storable... Types>
+  class basic_variable_view {
 
     public:
 
       using value_type = Variant<meta::copyable_type_for_t<Types>...>;
       using size_type = size_t;
       using difference_type = std::ptrdiff_t;
-      using iterator = basic_variable_iterator<Storage, Variant, Types...>;
+      using reference = basic_variable_reference<Variant, Types...>;
+      using const_reference = reference;
+      using iterator = basic_variable_iterator<basic_variable_view>;
       using const_iterator = iterator;
 
       using logical_type = Variant<Types...>;
-      using storage_type = Storage<logical_type>;
+
+      static constexpr auto type_bits = meta::rounded_bits_for<sizeof...(Types) - 1>();
 
     private:
 
+      static_assert(type_bits <= 8,
+          "varvec::basic_variable_view only supports packed type representations");
+
+      // The bit vector is never written through, the storage just isn't const-qualified.
+      using type_storage = storage::bitvec_api<type_bits, storage::bitvec_view_storage>;
+
       static constexpr bool nothrow_value_copyable =
         std::is_nothrow_copy_constructible_v<value_type>;
-      static constexpr bool nothrow_logical_copyable =
-        std::is_nothrow_copy_constructible_v<logical_type>;
-
-      static constexpr bool nothrow_value_movable =
-        std::is_nothrow_move_constructible_v<value_type>;
-      static constexpr bool nothrow_logical_movable =
-        std::is_nothrow_move_constructible_v<logical_type>;
 
       template <class T>
       static constexpr bool contained_type_v = (std::is_same_v<T, Types> || ...);
@@ -1347,138 +5005,73 @@ namespace varvec {
           contained_type_v<T> && !std::is_trivially_constructible_v<T>;
 
       template <class Func>
-      static constexpr bool exhaustive_visitor_v = (std::is_invocable_v<Func, Types&> && ...);
+      static constexpr bool exhaustive_visitor_v = (std::is_invocable_v<Func, Types const&> && ...);
 
       template <class Func>
-      static constexpr bool nothrow_exhaustive_visitor_v = (std::is_nothrow_invocable_v<Func, Types&> && ...);
-
-      template <class T>
-      static constexpr bool nothrow_insertable_v =
-          storage_type::has_nothrow_resize && std::is_nothrow_constructible_v<logical_type, T>;
-
-      template <class T>
-      static constexpr bool variant_is_insertable_v =
-          nothrow_logical_movable && std::is_same_v<std::decay_t<T>, logical_type>;
-
-      template <class T>
-      static constexpr bool type_is_insertable_v = nothrow_logical_movable
-          && std::is_constructible_v<logical_type, T> && !std::is_same_v<std::decay_t<T>, logical_type>;
+      static constexpr bool nothrow_exhaustive_visitor_v =
+          (std::is_nothrow_invocable_v<Func, Types const&> && ...);
 
     public:
 
-      basic_variable_vector()
-        noexcept(std::is_nothrow_constructible_v<storage_type>)
+      basic_variable_view() noexcept :
+        offsets(nullptr),
+        offset_width(sizeof(uint8_t)),
+        data(nullptr),
+        count(0),
+        data_bytes(0)
       {}
 
-      explicit basic_variable_vector(size_type start_members) :
-        impl(start_members)
-      {}
+      // Constructs a view over the individual regions of a packed representation.
+      // offset_width must be 1, 2, 4, or 8.
+      basic_variable_view(uint8_t const* types, uint8_t const* offsets, size_type offset_width,
+          uint8_t const* data, size_type count, size_type data_bytes) noexcept :
+        types(type_storage::bytes_for(count), const_cast<uint8_t*>(types)),
+        offsets(offsets),
+        offset_width(offset_width),
+        data(data),
+        count(count),
+        data_bytes(data_bytes)
+      {
+        assert(offset_width == 1 || offset_width == 2 || offset_width == 4 || offset_width == 8);
+      }
 
-      basic_variable_vector(basic_variable_vector const& other)
-        noexcept(nothrow_logical_copyable)
-        requires (std::copyable<Types> && ...)
+      // Constructs a view over a buffer previously written by basic_variable_vector::serialize.
+      // The buffer must outlive the view.
+      // Throws std::invalid_argument under the same conditions as basic_variable_vector::from_bytes.
+      explicit basic_variable_view(std::span<std::byte const> bytes)
+        requires (std::is_trivially_copyable_v<Types> && ...)
       :
-        impl(other.impl)
-      {}
+        basic_variable_view()
+      {
+        auto const head = serialization::read_header<logical_type>(bytes, type_bits);
+        serialization::layout const layout {type_bits, head.offset_width, head.count, head.data_bytes};
+        auto const* const base = reinterpret_cast<uint8_t const*>(bytes.data());
+
+        types = type_storage {type_storage::bytes_for(head.count),
+            const_cast<uint8_t*>(base + layout.types_begin())};
+        offsets = base + layout.offsets_begin();
+        offset_width = head.offset_width;
+        data = base + layout.data_begin();
+        count = head.count;
+        data_bytes = head.data_bytes;
+      }
 
-      basic_variable_vector(basic_variable_vector&& other)
-        noexcept(nothrow_logical_movable)
-      :
-        impl(std::move(other.impl))
-      {}
+      basic_variable_view(basic_variable_view const&) = default;
+      ~basic_variable_view() = default;
 
-      ~basic_variable_vector() = default;
+      basic_variable_view& operator =(basic_variable_view const&) = default;
 
       // Subscript operator. Creates a temporary variant to return.
       value_type operator [](size_type index) const noexcept(nothrow_value_copyable) {
         assert(index < size());
-        uint8_t const type = impl.types[index];
-        auto const offset = impl.get_offset(index);
-        auto* const curr_ptr = impl.get_data() + offset;
-        return storage::get_aligned_ptr_for(type, curr_ptr, meta::identity<logical_type> {},
+        return storage::get_aligned_ptr_for(types[index], data + get_offset(index),
+            meta::identity<logical_type> {},
             [] <class T> (T const* ptr) noexcept(nothrow_value_copyable) -> value_type {
           if constexpr (std::copyable<T>) return *ptr;
           else return ptr;
         });
       }
 
-      basic_variable_vector& operator =(basic_variable_vector const& other)
-        noexcept(std::is_nothrow_copy_assignable_v<storage_type>)
-        requires (std::copyable<Types> && ...)
-      {
-        if (&other == this) return *this;
-        impl = other.impl;
-        return *this;
-      }
-
-      basic_variable_vector& operator =(basic_variable_vector&& other)
-        noexcept(std::is_nothrow_move_assignable_v<storage_type>)
-      {
-        if (&other == this) return *this;
-        impl = std::move(other.impl);
-        return *this;
-      }
-
-      // Function handles forwarding in a std::variant of the right types.
-      template <class ValueType>
-      requires std::is_same_v<std::decay_t<ValueType>, logical_type>
-      void push_back(ValueType&& val)
-        noexcept(std::is_nothrow_constructible_v<std::decay_t<ValueType>, ValueType>)
-      {
-        std::visit([&] <class T> (T&& arg) { push_back(std::forward<T>(arg)); }, std::forward<ValueType>(val));
-      }
-
-      // Function handles forwarding in any type that's convertible to our variant type.
-      template <class ValueType>
-      requires (
-        std::is_constructible_v<logical_type, ValueType>
-        &&
-        !std::is_same_v<std::decay_t<ValueType>, logical_type>
-      )
-      void push_back(ValueType&& val)
-        noexcept(
-          storage_type::has_nothrow_resize
-          &&
-          std::is_nothrow_constructible_v<logical_type, ValueType>
-        )
-      {
-        // XXX: It's REALLY difficult to get overload resolution here to work
-        // the way we'd want. This implementation is based on the converting constructor
-        // constraint rules added to the standard for std::variant in C++20.
-        // For details, check paper P0608R3.
-        using stored_type = meta::fuzzy_type_match_t<ValueType, Types...>;
-
-        // Figure out where we'll store this thing, taking into account
-        // whether it needs to be aligned.
-        auto [data_ptr, alignment_bytes] = find_storage_base<stored_type, false>(impl.offset);
-
-        // Check if we have it.
-        while (!impl.has_space(sizeof(stored_type) + alignment_bytes) && data_ptr) {
-          // FIXME: Rethink grow strategy
-          // Static vector returns null on overflow if assertions are disabled. Will crash below.
-          data_ptr = impl.resize(2);
-        }
-
-        impl.incr_offset(alignment_bytes);
-        auto const curr_count = impl.count++;
-        if constexpr (std::is_trivially_copyable_v<stored_type>) {
-          // May copy to a misaligned address
-          // If you crash here you overflowed a static vector.
-          memcpy(data_ptr, &val, sizeof(stored_type));
-        } else {
-          // Will align at native requirements
-          // If you crash here you overflowed a static vector.
-          new(data_ptr) stored_type(std::forward<ValueType>(val));
-        }
-        impl.types[curr_count] = meta::index_of_v<stored_type, Types...>;
-        impl.set_offset(curr_count, impl.offset);
-        impl.incr_offset(sizeof(stored_type));
-      }
-
-      void pop_back() {
-        destroy_at(--impl.count);
-      }
-
       value_type front() const noexcept(nothrow_value_copyable) {
         return (*this)[0];
       }
@@ -1487,62 +5080,25 @@ namespace varvec {
         return (*this)[size() - 1];
       }
 
-      value_type at(size_t index) {
-        bounds_check(index);
-        return (*this)[index];
-      }
-
       value_type at(size_t index) const {
         bounds_check(index);
         return (*this)[index];
       }
 
       // Function allows std::visit style visitation syntax at a given index.
-      // Useful because it's the only call that allows universal mutation.
-      template <class Func>
-      requires exhaustive_visitor_v<Func>
-      void visit(size_type index, Func&& callback)
-        noexcept(nothrow_exhaustive_visitor_v<Func>)
-      {
-        // Very carefully forwarding noexcept here because it seems to make a difference.
-        constexpr bool is_noexcept = noexcept(nothrow_exhaustive_visitor_v<Func>);
-
-        uint8_t const type = impl.types[index];
-        auto const offset = impl.get_offset(index);
-        auto* const curr_ptr = impl.get_data() + offset;
-        storage::get_aligned_ptr_for(type, curr_ptr,
-            meta::identity<logical_type> {}, [&] <class T> (T* ptr) noexcept(is_noexcept) {
-          std::forward<Func>(callback)(*ptr);
-        });
-      }
-
-      // Function allows std::visit style visitation syntax at a given index.
-      // Useful because it's the only call that allows universal mutation.
       template <class Func>
       requires exhaustive_visitor_v<Func>
       void visit(size_type index, Func&& callback) const
         noexcept(nothrow_exhaustive_visitor_v<Func>)
       {
-        // Very carefully forwarding noexcept here because it seems to make a difference.
-        constexpr bool is_noexcept = noexcept(nothrow_exhaustive_visitor_v<Func>);
+        constexpr bool is_noexcept = nothrow_exhaustive_visitor_v<Func>;
 
-        const_cast<basic_variable_vector*>(this)->visit(index, [&] <class T> (T& val) noexcept(is_noexcept) {
-          std::forward<Func>(callback)(const_cast<T const&>(val));
+        storage::get_aligned_ptr_for(types[index], data + get_offset(index),
+            meta::identity<logical_type> {}, [&] <class T> (T const* ptr) noexcept(is_noexcept) {
+          std::forward<Func>(callback)(*ptr);
         });
       }
 
-      // Function allows std::visit style visitation syntax at a given index.
-      // Useful because it's the only call that allows universal mutation.
-      template <class Func>
-      requires exhaustive_visitor_v<Func>
-      void visit(iterator it, Func&& callback)
-        noexcept(nothrow_exhaustive_visitor_v<Func>)
-      {
-        visit(it.idx, std::forward<Func>(callback));
-      }
-
-      // Function allows std::visit style visitation syntax at a given index.
-      // Useful because it's the only call that allows universal mutation.
       template <class Func>
       requires exhaustive_visitor_v<Func>
       void visit(iterator it, Func&& callback) const
@@ -1551,91 +5107,82 @@ namespace varvec {
         visit(it.idx, std::forward<Func>(callback));
       }
 
-      // Function allows std::visit style visitation syntax at a given index.
-      // Useful because it's the only call that allows universal mutation.
       template <class Func>
       requires exhaustive_visitor_v<Func>
-      void visit_at(size_type index, Func&& callback) {
+      void visit_at(size_type index, Func&& callback) const {
         bounds_check(index);
         visit(index, std::forward<Func>(callback));
       }
 
       template <class Func>
       requires exhaustive_visitor_v<Func>
-      void visit_at(size_type index, Func&& callback) const {
-        const_cast<basic_variable_vector*>(this)->visit_at(index, [&] <class T> (T& val) {
-          std::forward<Func>(callback)(const_cast<T const&>(val));
-        });
+      void visit_at(iterator it, Func&& callback) const {
+        visit_at(it.idx, std::forward<Func>(callback));
       }
 
+      // Function visits every member in [first, last), in order,
+      // dispatching the offset width once for the whole range.
       template <class Func>
       requires exhaustive_visitor_v<Func>
-      void visit_at(iterator it, Func&& callback) {
-        visit_at(it.idx, std::forward<Func>(callback));
+      void visit_range(size_type first, size_type last, Func&& callback) const
+        noexcept(nothrow_exhaustive_visitor_v<Func>)
+      {
+        assert(first <= last && last <= size());
+
+        storage::offsets::dispatch_width(offset_width, [&] <class O> (meta::identity<O>) noexcept(nothrow_exhaustive_visitor_v<Func>) {
+          types.for_each_entry(first, last, [&] (size_type idx, uint8_t type) noexcept(nothrow_exhaustive_visitor_v<Func>) {
+            O offset;
+            memcpy(&offset, offsets + idx * sizeof(O), sizeof(O));
+            storage::get_aligned_ptr_for(type, data + offset,
+                meta::identity<logical_type> {}, [&] <class T> (T const* ptr) noexcept(nothrow_exhaustive_visitor_v<Func>) {
+              callback(*ptr);
+            });
+          });
+        });
       }
 
       template <class Func>
       requires exhaustive_visitor_v<Func>
-      void visit_at(iterator it, Func&& callback) const {
-        visit_at(it.idx, std::forward<Func>(callback));
-      }
-
-      template <class T>
-      requires nontrivial_get_reqs_v<T>
-      T& get(size_type index) & noexcept {
-        // Trust the user and grab it.
-        // Obviously this is UB if you call it with the wrong type
-        // If you want exceptions, call get_at.
-        return *reinterpret_cast<T*>(impl.get_data() + impl.get_offset(index));
-      }
-
-      template <class T>
-      requires nontrivial_get_reqs_v<T>
-      T const& get(size_type index) const& noexcept {
-        return const_cast<basic_variable_vector*>(this)->get<T>(index);
+      void visit_range(iterator first, iterator last, Func&& callback) const
+        noexcept(nothrow_exhaustive_visitor_v<Func>)
+      {
+        visit_range(first.idx, last.idx, std::forward<Func>(callback));
       }
 
-      template <class T>
-      requires nontrivial_get_reqs_v<T>
-      T&& get(size_type index) && noexcept {
-        return std::move(get<T>());
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_all(Func&& callback) const noexcept(nothrow_exhaustive_visitor_v<Func>) {
+        visit_range(0, size(), std::forward<Func>(callback));
       }
 
-      template <class T>
-      requires nontrivial_get_reqs_v<T>
-      T& get(iterator it) & noexcept {
-        return get<T>(it.idx);
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      Func for_each(Func callback) const noexcept(nothrow_exhaustive_visitor_v<Func>) {
+        visit_all(callback);
+        return callback;
       }
 
       template <class T>
       requires nontrivial_get_reqs_v<T>
-      T const& get(iterator it) const& noexcept {
-        return get<T>(it.idx);
+      T const& get(size_type index) const noexcept {
+        // Trust the user and grab it.
+        // If you want exceptions, call get_at.
+        return *reinterpret_cast<T const*>(data + get_offset(index));
       }
 
       template <class T>
       requires nontrivial_get_reqs_v<T>
-      T&& get(iterator it) && noexcept {
-        return std::move(*this).template get<T>(it.idx);
+      T const& get(iterator it) const noexcept {
+        return get<T>(it.idx);
       }
 
       template <class T>
       requires trivial_get_reqs_v<T>
       T get(size_type index) const noexcept {
-        // Trust the user and grab it.
-        // Obviously this is UB if you call it with the wrong type
-        // If you want exceptions, call get_at.
-        auto* const data_ptr = reinterpret_cast<T const*>(impl.get_data() + impl.get_offset(index));
-
-        // Since this overload is only for trivial types, the address
-        // could be misaligned, and so we copy into a temporary if so.
-        if (storage::aligned_for_type<T>(data_ptr)) {
-          return *data_ptr;
-        } else {
-          T retval;
-          memcpy(&retval, impl.get_data() + impl.get_offset(index), sizeof(T));
-          return retval;
-        }
+        // Address could be misaligned, so copy out.
+        T retval;
+        memcpy(&retval, data + get_offset(index), sizeof(T));
+        return retval;
       }
 
       template <class T>
@@ -1645,176 +5192,458 @@ namespace varvec {
       }
 
       template <class T>
-      requires nontrivial_get_reqs_v<T>
-      T& get_at(size_type index) & {
-        // Bounds and type checks.
+      requires contained_type_v<T>
+      decltype(auto) get_at(size_type index) const {
         bounds_check(index);
-        if (impl.types[index] != meta::index_of_v<T, Types...>) {
+        if (types[index] != meta::index_of_v<T, Types...>) {
           throw std::bad_cast();
         }
         return get<T>(index);
       }
 
       template <class T>
-      requires nontrivial_get_reqs_v<T>
-      T const& get_at(size_type index) const& {
-        return const_cast<basic_variable_vector*>(this)->get_at<T>(index);
+      requires contained_type_v<T>
+      decltype(auto) get_at(iterator it) const {
+        return get_at<T>(it.idx);
       }
 
+      // Function counts the members of the view that are of type T.
       template <class T>
-      requires nontrivial_get_reqs_v<T>
-      T&& get_at(size_type index) && {
-        return std::move(get_at<T>());
+      requires contained_type_v<T>
+      size_type count_of() const noexcept {
+        return types.count(meta::index_of_v<T, Types...>, size());
       }
 
+      // Function returns the index of the first member of type T, or size() if there isn't one.
       template <class T>
-      requires nontrivial_get_reqs_v<T>
-      T& get_at(iterator it) & {
-        return get_at<T>(it.idx);
+      requires contained_type_v<T>
+      size_type find_first() const noexcept {
+        return find_next<T>(0);
       }
 
+      // Function returns the index of the first member of type T at or after the given index,
+      // or size() if there isn't one.
       template <class T>
-      requires nontrivial_get_reqs_v<T>
-      T const& get_at(iterator it) const& {
-        return get_at<T>(it.idx);
+      requires contained_type_v<T>
+      size_type find_next(size_type from) const noexcept {
+        return types.find(meta::index_of_v<T, Types...>, from, size());
       }
 
+      // Function returns the indexes of every member of type T, in order.
       template <class T>
-      requires nontrivial_get_reqs_v<T>
-      T&& get_at(iterator it) && {
-        return std::move(*this).template get_at<T>(it.idx);
+      requires contained_type_v<T>
+      std::vector<size_type> positions_of() const {
+        std::vector<size_type> positions;
+        types.for_each_match(meta::index_of_v<T, Types...>, size(), [&] (size_type idx) {
+          positions.push_back(idx);
+        });
+        return positions;
       }
 
+      // Function returns a range over only the members of type T.
+      // See basic_variable_vector::view_of.
       template <class T>
-      requires trivial_get_reqs_v<T>
-      T get_at(size_type index) const {
-        // Bounds and type checks.
-        bounds_check(index);
-        if (impl.types[index] != meta::index_of_v<T, Types...>) {
-          throw std::bad_cast();
+      requires contained_type_v<T>
+      basic_typed_view<basic_variable_view const, T> view_of() const noexcept {
+        return basic_typed_view<basic_variable_view const, T> {*this};
+      }
+
+      size_type size() const noexcept {
+        return count;
+      }
+
+      bool empty() const noexcept {
+        return size() == 0;
+      }
+
+      size_type used_bytes() const noexcept {
+        return data_bytes;
+      }
+
+      iterator begin() const noexcept {
+        return iterator {0, this};
+      }
+
+      iterator end() const noexcept {
+        return iterator {size(), this};
+      }
+
+    private:
+
+      friend iterator;
+
+      reference reference_at(size_type index) const noexcept {
+        return reference {types[index], data + get_offset(index)};
+      }
+
+      size_type get_offset(size_type index) const noexcept {
+        // The offset table isn't guaranteed to be aligned inside of a serialized buffer.
+        return storage::offsets::dispatch_width(offset_width, [&] <class O> (meta::identity<O>) {
+          O offset;
+          memcpy(&offset, offsets + index * sizeof(O), sizeof(O));
+          return static_cast<size_type>(offset);
+        });
+      }
+
+      void bounds_check(size_t index) const {
+        if (index >= size()) {
+          std::string msg = "varvec::view was indexed out of bounds. ";
+          msg += "Index was: " + std::to_string(index);
+          msg += ", size was: " + std::to_string(size());
+          throw std::out_of_range(msg);
         }
-        return get<T>(index);
       }
 
+      type_storage types;
+      uint8_t const* offsets;
+      size_type offset_width;
+      uint8_t const* data;
+      size_type count;
+      size_type data_bytes;
+
+      friend bool operator ==(basic_variable_view const& lhs, basic_variable_view const& rhs)
+        noexcept(noexcept(*lhs.begin() != *rhs.begin()))
+      {
+        auto lhs_it = lhs.begin();
+        auto rhs_it = rhs.begin();
+        while (lhs_it != lhs.end() && rhs_it != rhs.end()) {
+          if (*lhs_it++ != *rhs_it++) return false;
+        }
+        return lhs_it == lhs.end() && rhs_it == rhs.end();
+      }
+
+  };
+
+  // Forward iterator over the members of a single type within a vector or view.
+  // Advancing uses the container's find_next, so runs of other types are skipped
+  // a word of type tags at a time.
+  template <class Container, class T>
+  class basic_typed_iterator {
+
+    public:
+
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using reference = decltype(std::declval<Container&>().template get<T>(size_t {}));
+      using size_type = size_t;
+
+      basic_typed_iterator() noexcept :
+        idx(0),
+        container(nullptr)
+      {}
+
+      basic_typed_iterator(size_type idx, Container* container) noexcept :
+        idx(idx),
+        container(container)
+      {}
+
+      reference operator *() const noexcept {
+        return container->template get<T>(idx);
+      }
+
+      basic_typed_iterator& operator ++() noexcept {
+        idx = container->template find_next<T>(idx + 1);
+        return *this;
+      }
+
+      basic_typed_iterator operator ++(int) noexcept {
+        auto tmp {*this};
+        ++*this;
+        return tmp;
+      }
+
+      // Index of the current member within the container.
+      size_type index() const noexcept {
+        return idx;
+      }
+
+    private:
+
+      size_type idx;
+      Container* container;
+
+      friend bool operator ==(basic_typed_iterator const& lhs, basic_typed_iterator const& rhs) noexcept {
+        return lhs.idx == rhs.idx && lhs.container == rhs.container;
+      }
+
+  };
+
+  // Forward range over the members of a single type within a vector or view.
+  // Returned by view_of<T>().
+  template <class Container, class T>
+  class basic_typed_view : public std::ranges::view_interface<basic_typed_view<Container, T>> {
+
+    public:
+
+      using iterator = basic_typed_iterator<Container, T>;
+
+      basic_typed_view() noexcept :
+        container(nullptr)
+      {}
+
+      explicit basic_typed_view(Container& container) noexcept :
+        container(&container)
+      {}
+
+      iterator begin() const noexcept {
+        return iterator {container->template find_first<T>(), container};
+      }
+
+      iterator end() const noexcept {
+        return iterator {container->size(), container};
+      }
+
+    private:
+
+      Container* container;
+
+  };
+
+  // Class implements an append-oriented packed vector as a list of fixed size chunks.
+  // Each chunk is a heap allocated static vector, with its own packed types, offsets,
+  // and data, and a small index records the position each chunk starts at.
+  //
+  // Chunks never move or grow, so appending never reallocates or moves existing members,
+  // and pointers and references to members stay valid until that member is removed.
+  // Peak memory is the contents plus one partially filled chunk, instead of twice the
+  // contents during a reallocation. Appending is constant time, apart from the amortized
+  // growth of the index, which holds one entry per chunk.
+  //
+  // Each chunk can also be used directly, for example to process chunks in parallel.
+  template <size_t chunk_bytes, size_t chunk_members,
+           template <class...> class Variant, meta::storable... Types>
+  class basic_segmented_vector {
+
+    public:
+
+      using value_type = Variant<meta::copyable_type_for_t<Types>...>;
+      using size_type = size_t;
+      using difference_type = std::ptrdiff_t;
+      using reference = basic_variable_reference<Variant, Types...>;
+      using const_reference = reference;
+      using iterator = basic_variable_iterator<basic_segmented_vector>;
+      using const_iterator = iterator;
+
+      using logical_type = Variant<Types...>;
+      using chunk_type = basic_variable_vector<
+        storage::static_storage_context<chunk_bytes, chunk_members>::template static_storage,
+        Variant,
+        Types...
+      >;
+
+    private:
+
+      static_assert(chunk_members > 0);
+
+      // Every type has to fit into an empty chunk, however it ends up aligned.
+      static_assert(((sizeof(Types) + alignof(Types) - 1 <= chunk_bytes) && ...),
+          "Chunks must be large enough to hold any one member");
+
       template <class T>
-      requires trivial_get_reqs_v<T>
-      T get_at(iterator it) const {
-        return get_at<T>(it.idx);
+      static constexpr bool contained_type_v = (std::is_same_v<T, Types> || ...);
+
+      template <class Func>
+      static constexpr bool exhaustive_visitor_v = (std::is_invocable_v<Func, Types&> && ...);
+
+      template <class Func>
+      static constexpr bool nothrow_exhaustive_visitor_v = (std::is_nothrow_invocable_v<Func, Types&> && ...);
+
+    public:
+
+      basic_segmented_vector() noexcept : count(0) {}
+
+      basic_segmented_vector(basic_segmented_vector const& other)
+        requires (std::copyable<Types> && ...)
+      :
+        starts(other.starts),
+        count(other.count)
+      {
+        chunks.reserve(other.chunks.size());
+        for (auto const& chunk : other.chunks) {
+          chunks.push_back(std::make_unique<chunk_type>(*chunk));
+        }
       }
 
-      template <class ValueType>
-      requires variant_is_insertable_v<ValueType>
-      void insert(size_type idx, ValueType&& val)
-        noexcept(
-          storage_type::has_nothrow_resize
-          &&
-          std::is_nothrow_constructible_v<logical_type, ValueType>
-        )
+      basic_segmented_vector(basic_segmented_vector&& other) noexcept :
+        chunks(std::move(other.chunks)),
+        starts(std::move(other.starts)),
+        count(std::exchange(other.count, 0))
+      {}
+
+      ~basic_segmented_vector() = default;
+
+      basic_segmented_vector& operator =(basic_segmented_vector const& other)
+        requires (std::copyable<Types> && ...)
       {
-        std::visit([&] <class T> (T&& arg) { insert(idx, std::forward<T>(arg)); }, std::forward<ValueType>(val));
+        if (&other == this) return *this;
+        auto tmp {other};
+        *this = std::move(tmp);
+        return *this;
+      }
+
+      basic_segmented_vector& operator =(basic_segmented_vector&& other) noexcept {
+        if (&other == this) return *this;
+        chunks = std::move(other.chunks);
+        starts = std::move(other.starts);
+        count = std::exchange(other.count, 0);
+        return *this;
+      }
+
+      // Subscript operator. Creates a temporary variant to return.
+      value_type operator [](size_type index) const {
+        auto [chunk, local] = locate(index);
+        return (*chunks[chunk])[local];
       }
 
+      // Function handles forwarding in a std::variant of the right types.
       template <class ValueType>
-      requires variant_is_insertable_v<ValueType>
-      void insert(iterator it, ValueType&& val) noexcept(nothrow_insertable_v<ValueType>) {
-        insert(it.idx, std::forward<ValueType>(val));
+      requires std::is_same_v<std::decay_t<ValueType>, logical_type>
+      void push_back(ValueType&& val) {
+        std::visit([&] <class T> (T&& arg) {
+          emplace_back<std::decay_t<T>>(std::forward<T>(arg));
+        }, std::forward<ValueType>(val));
+      }
+
+      // Function copies in the member behind an iterator's proxy reference.
+      void push_back(reference const& val) requires (std::copyable<Types> && ...) {
+        val.visit([&] <class T> (T const& arg) { emplace_back<T>(arg); });
       }
 
+      // Function handles forwarding in any type that's convertible to our variant type.
       template <class ValueType>
-      requires type_is_insertable_v<ValueType>
-      void insert(size_type idx, ValueType&& val) noexcept(nothrow_insertable_v<ValueType>) {
-        using stored_type = meta::fuzzy_type_match_t<ValueType, Types...>;
-        assert(idx <= size());
+      requires (
+        std::is_constructible_v<logical_type, ValueType>
+        &&
+        !std::is_same_v<std::decay_t<ValueType>, logical_type>
+        &&
+        !std::is_same_v<std::decay_t<ValueType>, reference>
+      )
+      void push_back(ValueType&& val) {
+        emplace_back<meta::fuzzy_type_match_t<ValueType, Types...>>(std::forward<ValueType>(val));
+      }
 
-        // If this is equivalent to a push_back, just call that.
-        if (idx == size()) {
-          push_back(std::forward<ValueType>(val));
-          return;
+      // Function constructs a T in place at the end of the last chunk, starting a new chunk
+      // if the last one can't fit it. Existing members are never touched.
+      template <class T, class... Args>
+      requires contained_type_v<T> && std::is_constructible_v<T, Args...>
+      void emplace_back(Args&&... args) {
+        if (chunks.empty() || !chunks.back()->template has_space_for<T>()) {
+          add_chunk();
         }
+        chunks.back()->template emplace_back<T>(std::forward<Args>(args)...);
+        ++count;
+      }
 
-        // Find the insert point and how much additional space we'll need
-        auto [additional_space, move_point] = find_insert_move_point<stored_type>(idx);
-
-        // Make sure we have space.
-        // FIXME: Rethink grow strategy
-        // Static vector returns null on overflow if assertions are disabled.
-        while (!impl.has_space(additional_space) && impl.resize(2));
+      // Function removes the last member, and releases the last chunk once it's empty.
+      void pop_back() {
+        assert(!empty());
+        chunks.back()->pop_back();
+        --count;
+        if (chunks.back()->empty()) {
+          chunks.pop_back();
+          starts.pop_back();
+        }
+      }
 
-        // Move everything forwards by the necessary offset, walking backwards from the end.
-        walk_backward_move_forward(idx, move_point);
+      void clear() noexcept {
+        chunks.clear();
+        starts.clear();
+        count = 0;
+      }
 
-        // Perform the actual insert.
-        auto curr_offset = impl.get_offset(idx);
-        auto [insert_ptr, alignment_bytes] = find_storage_base<stored_type, false>(curr_offset);
-        if constexpr (std::is_trivially_copyable_v<stored_type>) {
-          memcpy(insert_ptr, &val, sizeof(stored_type));
-        } else {
-          new(insert_ptr) stored_type(std::forward<ValueType>(val));
-        }
+      template <class T>
+      requires contained_type_v<T>
+      decltype(auto) get(size_type index) noexcept {
+        auto [chunk, local] = locate(index);
+        return chunks[chunk]->template get<T>(local);
+      }
 
-        // Update all bookkeeping
-        impl.types[idx] = meta::index_of_v<stored_type, Types...>;
-        impl.set_offset(idx, curr_offset + alignment_bytes);
-        impl.incr_offset(additional_space);
-        ++impl.count;
+      template <class T>
+      requires contained_type_v<T>
+      decltype(auto) get(size_type index) const noexcept {
+        auto [chunk, local] = locate(index);
+        return std::as_const(*chunks[chunk]).template get<T>(local);
       }
 
-      template <class ValueType>
-      requires type_is_insertable_v<ValueType>
-      void insert(iterator it, ValueType&& val) noexcept(nothrow_insertable_v<ValueType>) {
-        insert(it.idx, std::forward<ValueType>(val));
+      // Function allows std::visit style visitation syntax at a given index.
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit(size_type index, Func&& callback) noexcept(nothrow_exhaustive_visitor_v<Func>) {
+        auto [chunk, local] = locate(index);
+        chunks[chunk]->visit(local, std::forward<Func>(callback));
+      }
+
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit(size_type index, Func&& callback) const noexcept(nothrow_exhaustive_visitor_v<Func>) {
+        auto [chunk, local] = locate(index);
+        std::as_const(*chunks[chunk]).visit(local, std::forward<Func>(callback));
       }
 
-      iterator erase(size_type idx) noexcept requires nothrow_logical_movable {
-        assert(idx < size());
+      // Function visits every member in [first, last), in order, one chunk at a time.
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_range(size_type first, size_type last, Func&& callback)
+        noexcept(nothrow_exhaustive_visitor_v<Func>)
+      {
+        visit_chunks(*this, first, last, callback);
+      }
 
-        // Knock out the requested index and shift everything backwards
-        impl.offset = walk_forward_move_backward(idx);
-        --impl.count;
-        return begin() + idx;
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_range(size_type first, size_type last, Func&& callback) const
+        noexcept(nothrow_exhaustive_visitor_v<Func>)
+      {
+        visit_chunks(*this, first, last, callback);
       }
 
-      iterator erase(iterator it) noexcept requires nothrow_logical_movable {
-        return erase(it.idx);
+      // Function visits every member of the vector, in order.
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_all(Func&& callback) noexcept(nothrow_exhaustive_visitor_v<Func>) {
+        visit_range(0, size(), std::forward<Func>(callback));
       }
 
-      size_type size() const noexcept {
-        return impl.count;
+      template <class Func>
+      requires exhaustive_visitor_v<Func>
+      void visit_all(Func&& callback) const noexcept(nothrow_exhaustive_visitor_v<Func>) {
+        visit_range(0, size(), std::forward<Func>(callback));
       }
 
-      size_type capacity() const noexcept {
-        return impl.max_members();
+      size_type size() const noexcept {
+        return count;
       }
 
       bool empty() const noexcept {
         return size() == 0;
       }
 
-      template <class ValueType>
-      requires std::is_same_v<std::decay_t<ValueType>, logical_type>
-      bool has_space(ValueType const& val) const noexcept {
-        return std::visit([&] (auto& arg) { return has_space(arg); });
+      size_type chunk_count() const noexcept {
+        return chunks.size();
       }
 
-      template <class ValueType>
-      requires (
-          std::is_constructible_v<logical_type, ValueType>
-          &&
-          !std::is_same_v<std::decay_t<ValueType>, logical_type>
-      )
-      bool has_space(ValueType const&) const noexcept {
-        // Compute the type we would store for this argument
-        using stored_type = meta::fuzzy_type_match_t<ValueType, Types...>;
+      chunk_type& chunk(size_type idx) noexcept {
+        assert(idx < chunk_count());
+        return *chunks[idx];
+      }
 
-        // Figure out if we need space for alignment
-        auto [_, alignment_bytes] = find_storage_base<stored_type>(impl.offset);
+      chunk_type const& chunk(size_type idx) const noexcept {
+        assert(idx < chunk_count());
+        return *chunks[idx];
+      }
 
-        // Check if we have it.
-        return impl.has_space(sizeof(stored_type) + alignment_bytes);
+      // Index of the first member stored in the given chunk.
+      size_type chunk_start(size_type idx) const noexcept {
+        assert(idx < chunk_count());
+        return starts[idx];
       }
 
       size_type used_bytes() const noexcept {
-        return impl.size();
+        size_type total = starts.capacity() * sizeof(size_type)
+            + chunks.capacity() * sizeof(std::unique_ptr<chunk_type>);
+        for (auto const& chunk : chunks) total += chunk->used_bytes();
+        return total;
       }
 
       iterator begin() const noexcept {
@@ -1827,235 +5656,53 @@ namespace varvec {
 
     private:
 
-      template <class ValueType, bool is_const = true>
-      auto find_storage_base(size_type offset) const noexcept {
-        auto* const base_ptr = impl.get_data() + offset;
-        auto* data_ptr = base_ptr;
-
-        // Figure out how much space we'll need.
-        auto const required_bytes = sizeof(ValueType);
-        if constexpr (!std::is_trivially_copyable_v<ValueType>) {
-          data_ptr = storage::realign_for_type<ValueType>(data_ptr);
-        }
-        auto const alignment_bytes = data_ptr - base_ptr;
-
-        if constexpr (is_const) {
-          return std::tuple {data_ptr, alignment_bytes};
-        } else {
-          return std::tuple {const_cast<uint8_t*>(data_ptr), alignment_bytes};
-        }
-      }
-
-      template <class InsertType>
-      auto find_insert_move_point(size_type index) const noexcept {
-        // Pre-compute all metadata for the type we're inserting
-        uint8_t prev_type_of = meta::index_of_v<InsertType, Types...>;
-        auto& align_info = storage::alignment_map_for_v<value_type>;
-        auto prev = align_info[prev_type_of];
-
-        // Walk index by index and compute how much space we'll need to perform the insert.
-        auto curr_idx = index;
-        auto curr_offset = impl.get_offset(curr_idx);
-        while (curr_idx <= size()) {
-          // Prospective address of the current index.
-          auto* const curr_ptr = impl.get_data() + curr_offset;
-
-          // If the previous storage index were to be relocated based on this pointer,
-          // would it also need to be realigned?
-          if (prev.needs_align) {
-            auto* const aligned_ptr =
-                storage::realign_for_type_index<value_type>(curr_ptr, prev_type_of);
-            curr_offset += aligned_ptr - curr_ptr;
-          }
-          curr_offset += prev.size_of;
-
-          // Update
-          if (curr_idx < size()) {
-            prev_type_of = impl.types[curr_idx];
-            prev = align_info[prev_type_of];
-          }
-          ++curr_idx;
-        }
-
-        // curr_offset is now pushed all the way to the end of the bytes needed for the insert.
-        // From this, compute the first destination address for the move routine (offset minus size
-        // of final element), along with the number of additional bytes we'll need to use in total.
-        auto move_point = curr_offset - align_info[impl.types[size() - 1]].size_of;
-        return std::tuple {curr_offset - impl.offset, move_point};
-      }
-
-      void walk_backward_move_forward(size_type insert_index, size_type move_point) noexcept {
-        static_assert(nothrow_logical_movable);
-
-        auto curr_idx = size();
-        auto& align_info = storage::alignment_map_for_v<value_type>;
-        do {
-          // do-while and start with decrement
-          // to handle counting down to zero with an unsigned type.
-          --curr_idx;
-
-          // Get current metadata
-          uint8_t const type_index = impl.types[curr_idx];
-          auto const& curr = align_info[type_index];
-
-          // Compute from/to
-          uint8_t* const move_dst = impl.get_data() + move_point;
-          uint8_t* const move_src = impl.get_data() + impl.get_offset(curr_idx);
-
-          // Sanity checks
-          auto const well_aligned =
-              storage::aligned_for_type_index<value_type>(move_src, type_index)
-              &&
-              storage::aligned_for_type_index<value_type>(move_dst, type_index);
-          assert(well_aligned || !curr.needs_align);
-
-          // Perform the move, conditional on if the type is trivially copyable (needs alignment)
-          if (move_src != move_dst) {
-            if (curr.needs_align) {
-              // Handles carefully calling a move constructor on pointers that may overlap.
-              move_overlapping_pointers(curr, move_src, move_dst, type_index);
-            } else {
-              // Regions can overlap, so we can't memcpy
-              memmove(move_dst, move_src, curr.size_of);
-            }
-          }
-
-          // Update type and offset
-          impl.types[curr_idx + 1] = type_index;
-          impl.set_offset(curr_idx + 1, move_point);
-
-          // Compute next move target
-          if (curr_idx > insert_index) {
-            // Get the type of the next thing to be moved.
-            uint8_t const next_type = impl.types[curr_idx - 1];
-            auto const& next = align_info[next_type];
-
-            // Compute the offset for the next object
-            uint8_t* next_dst;
-            if (next.needs_align) {
-              next_dst = storage::realign_backwards_for(move_dst - next.size_of, next.align_of);
-            } else {
-              next_dst = move_dst - next.size_of;
-            }
-            move_point = next_dst - impl.get_data();
-          }
-        } while (curr_idx != insert_index);
-      }
-
-      size_type walk_forward_move_backward(size_type erase_point) noexcept {
-        // Walk forward and shift each object back one index
-        auto curr_idx = erase_point;
-        auto curr_offset = impl.get_offset(curr_idx);
-        auto& align_info = storage::alignment_map_for_v<value_type>;
-        while (true) {
-          // Destroy the current index and break if it's the final element.
-          destroy_at(curr_idx);
-          if (curr_idx == size() - 1) break;
-
-          // Get type and alignment info for the index we're moving
-          uint8_t const type_index = impl.types[curr_idx + 1];
-          auto const& curr = align_info[type_index];
-
-          // Compute the new storage location
-          auto* move_dst = impl.get_data() + curr_offset;
-          if (curr.needs_align) {
-            move_dst = storage::realign_for_type_index<value_type>(move_dst, type_index);
-            curr_offset = move_dst - impl.get_data();
-          }
-
-          // Compute the current storage location
-          auto const src_offset = impl.get_offset(curr_idx + 1);
-          auto* move_src = impl.get_data() + src_offset;
-
-          // Sanity checks
-          auto const well_aligned =
-              storage::aligned_for_type_index<value_type>(move_src, type_index)
-              &&
-              storage::aligned_for_type_index<value_type>(move_dst, type_index);
-          assert(well_aligned || !curr.needs_align);
-
-          // Perform the move, conditional on if the type is trivially copyable (needs alignment)
-          if (move_src != move_dst) {
-            if (curr.needs_align) {
-              move_overlapping_pointers(curr, move_src, move_dst, type_index);
-            } else {
-              memmove(move_dst, move_src, curr.size_of);
-            }
-          }
-
-          // Update bookkeeping
-          impl.types[curr_idx] = type_index;
-          impl.set_offset(curr_idx, move_dst - impl.get_data());
+      friend iterator;
 
-          curr_offset += curr.size_of;
-          ++curr_idx;
-        }
-        return curr_offset;
+      reference reference_at(size_type index) const noexcept {
+        auto [chunk, local] = locate(index);
+        return *(chunks[chunk]->begin() + local);
       }
 
-      void move_overlapping_pointers(auto const& align,
-          uint8_t* move_src, uint8_t* move_dst, uint8_t type_index) noexcept
-        requires nothrow_logical_movable
-      {
-        storage::get_typed_ptr_for(type_index, move_src,
-            meta::identity<logical_type> {}, [&] <class T> (T* srcptr) noexcept {
-          static_assert(!std::is_const_v<T>);
-
-          // XXX: Have to be very careful here.
-          //
-          // The move_src and move_dst can potentially overlap in memory, and if they do
-          // we have to move through an intermediate object to prevent accidentally corrupting
-          // the object while we move from it.
-          //
-          // The check is formulated as it is so it'll work regardless of which is first in memory.
-          auto const srcintptr = reinterpret_cast<std::uintptr_t>(srcptr);
-          auto const destintptr = reinterpret_cast<std::uintptr_t>(move_dst);
-          if (std::max(srcintptr, destintptr) <
-              std::min(srcintptr + align.size_of, destintptr + align.size_of)) {
-            T tmp(std::move(*srcptr));
-            srcptr->~T();
+      // Function finds the chunk holding the given index, and the index within that chunk.
+      std::pair<size_type, size_type> locate(size_type index) const noexcept {
+        assert(index < size());
 
-            // We call placement-new here on an untyped pointer.
-            // The idea is hopefully encourage the compiler to realize that it might alias
-            new(move_dst) T(std::move(tmp));
-          } else {
-            new(move_dst) T(std::move(*srcptr));
-            srcptr->~T();
-          }
-        });
+        // Most accesses are to recently appended members, so check the last chunk first.
+        if (index >= starts.back()) return {starts.size() - 1, index - starts.back()};
+        auto const chunk = std::upper_bound(starts.begin(), starts.end(), index) - starts.begin() - 1;
+        return {chunk, index - starts[chunk]};
       }
 
-      void destroy_at(size_type index) noexcept {
-        uint8_t const type = impl.types[index];
-        auto const offset = impl.get_offset(index);
-        auto* const curr_ptr = impl.get_data() + offset;
-        storage::get_aligned_ptr_for(type, curr_ptr,
-            meta::identity<logical_type> {}, [] <class T> (T* ptr) noexcept {
-          ptr->~T();
-        });
+      void add_chunk() {
+        starts.reserve(starts.size() + 1);
+        chunks.push_back(std::make_unique<chunk_type>());
+        starts.push_back(count);
       }
 
-      void bounds_check(size_t index) const {
-        if (index >= size()) {
-          std::string msg = "varvec::vector was indexed out of bounds. ";
-          msg += "Index was: " + std::to_string(index);
-          msg += ", size was: " + std::to_string(size());
-          throw std::out_of_range(msg);
+      template <class Self, class Func>
+      static void visit_chunks(Self& self, size_type first, size_type last, Func& callback) {
+        assert(first <= last && last <= self.size());
+        if (first == last) return;
+
+        auto [chunk, local] = self.locate(first);
+        while (first < last) {
+          auto& curr = *self.chunks[chunk];
+          auto const stop = std::min(curr.size(), local + (last - first));
+          if constexpr (std::is_const_v<Self>) std::as_const(curr).visit_range(local, stop, callback);
+          else curr.visit_range(local, stop, callback);
+          first += stop - local;
+          local = 0;
+          ++chunk;
         }
       }
 
-      storage_type impl;
+      std::vector<std::unique_ptr<chunk_type>> chunks;
+      std::vector<size_type> starts;
+      size_type count;
 
-      // FIXME: We can do better performance wise
-      friend bool operator ==(basic_variable_vector const& lhs, basic_variable_vector const& rhs)
-        noexcept(noexcept(*lhs.begin() != *rhs.begin()))
-      {
-        auto lhs_it = lhs.begin();
-        auto rhs_it = rhs.begin();
-        while (lhs_it != lhs.end() && rhs_it != rhs.end()) {
-          if (*lhs_it++ != *rhs_it++) return false;
-        }
-        return lhs_it == lhs.end() && rhs_it == rhs.end();
+      friend bool operator ==(basic_segmented_vector const& lhs, basic_segmented_vector const& rhs) {
+        if (lhs.size() != rhs.size()) return false;
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin());
       }
 
   };
@@ -2078,6 +5725,63 @@ namespace varvec {
     Types...
   >;
 
+  // A packed, variant vector that stores up to a fixed number of bytes and members inline,
+  // and transparently migrates to the heap if it ever outgrows them.
+  template <size_t inline_bytes, size_t inline_members, meta::storable... Types>
+  using small_vector = basic_variable_vector<
+    storage::small_storage_context<inline_bytes, inline_members>::template small_storage,
+    std::variant,
+    Types...
+  >;
+
+  // A dynamically sized, packed, variant vector that keeps its data and all of its
+  // metadata in a single allocation.
+  template <meta::storable... Types>
+  using block_vector = basic_variable_vector<
+    storage::block_storage,
+    std::variant,
+    Types...
+  >;
+
+  // A packed, variant vector made of fixed size chunks of the given size, which never
+  // reallocates or moves its members as it grows.
+  template <size_t chunk_bytes, size_t chunk_members, meta::storable... Types>
+  using segmented_vector = basic_segmented_vector<chunk_bytes, chunk_members, std::variant, Types...>;
+
+  // A read-only view over a packed, variant vector, or a serialized copy of one.
+  template <meta::storable... Types>
+  using vector_view = basic_variable_view<std::variant, Types...>;
+
+#ifdef __linux__
+  // A dynamically sized, packed, variant vector that lives in a memory mapped file,
+  // and persists across runs.
+  template <meta::storable... Types>
+  using mapped_vector = basic_variable_vector<
+    storage::mapped_storage,
+    std::variant,
+    Types...
+  >;
+#endif
+
+  namespace pmr {
+    // A dynamically sized, packed, variant vector that performs all of its
+    // allocations through a std::pmr::memory_resource.
+    template <meta::storable... Types>
+    using vector = basic_variable_vector<
+      storage::pmr_storage,
+      std::variant,
+      Types...
+    >;
+  }
+
+  // Function erases every member of the vector for which the predicate returns true,
+  // like std::erase_if. See basic_variable_vector::remove_if.
+  template <template <class> class Storage,
+           template <class...> class Variant, meta::storable... Types, class Pred>
+  auto erase_if(basic_variable_vector<Storage, Variant, Types...>& vec, Pred pred) {
+    return vec.remove_if(std::move(pred));
+  }
+
   // XXX: Feels like this should really be in varvec::meta, but it's so useful for
   // visitation that I want it to be easier to type, and it can't be a type alias
   // here because CTAD doesn't work for type aliases...
@@ -2089,3 +5793,96 @@ namespace varvec {
   overload(Funcs...) -> overload<Funcs...>;
 
 }
+
+namespace varvec::parallel {
+
+  // Members per unit of work. Large enough to amortize the scheduling overhead, and
+  // small enough that the offsets and type tags a chunk touches stay in cache,
+  // and that uneven per-member costs balance out across threads.
+  inline constexpr size_t default_chunk_members = 1 << 14;
+
+  inline size_t default_thread_count() noexcept {
+    return std::max(std::thread::hardware_concurrency(), 1U);
+  }
+
+  // Splits [0, members) into chunks, and runs the callback on every chunk index,
+  // using up to threads threads, including the calling thread.
+  // Threads claim chunks from a shared counter as they finish, so a slow chunk doesn't
+  // hold up the rest. The first exception thrown by the callback stops the remaining
+  // chunks, and is rethrown on the calling thread.
+  template <class Func>
+  void run_chunked(size_t chunks, size_t threads, Func&& callback) {
+    threads = std::min(std::max(threads, size_t {1}), chunks);
+    if (threads <= 1) {
+      for (size_t chunk = 0; chunk < chunks; ++chunk) callback(chunk);
+      return;
+    }
+
+    std::atomic<size_t> next {0};
+    std::atomic<bool> failed {false};
+    std::exception_ptr error;
+    auto work = [&] () noexcept {
+      try {
+        for (auto chunk = next++; chunk < chunks && !failed.load(std::memory_order_relaxed); chunk = next++) {
+          callback(chunk);
+        }
+      } catch (...) {
+        if (!failed.exchange(true)) error = std::current_exception();
+      }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t i = 1; i < threads; ++i) workers.emplace_back(work);
+    work();
+    for (auto& worker : workers) worker.join();
+    if (error) std::rethrow_exception(error);
+  }
+
+  // Function visits every member of a vector or view, like visit_all, but splits the index
+  // space into chunks and visits them concurrently with visit_range.
+  // The callback is shared by all threads, so it must be safe to call concurrently,
+  // and members are not visited in any particular order.
+  template <class Container, class Func>
+  void for_each(Container&& vec, Func&& callback,
+      size_t threads = default_thread_count(), size_t chunk_members = default_chunk_members)
+  {
+    assert(chunk_members);
+    auto const size = vec.size();
+    auto const chunks = (size + chunk_members - 1) / chunk_members;
+    run_chunked(chunks, threads, [&] (size_t chunk) {
+      auto const first = chunk * chunk_members;
+      vec.visit_range(first, std::min(first + chunk_members, size), callback);
+    });
+  }
+
+  // Function transforms every member of a vector or view and reduces the results, like
+  // std::transform_reduce, with chunks reduced concurrently.
+  // Each chunk is reduced in index order, and the per-chunk results are then folded into
+  // init in chunk order, so the result doesn't depend on the thread count, even for
+  // non-associative operations like floating point addition.
+  template <class Container, class T, class Reduce, class Transform>
+  T transform_reduce(Container&& vec, T init, Reduce reduce, Transform transform,
+      size_t threads = default_thread_count(), size_t chunk_members = default_chunk_members)
+  {
+    assert(chunk_members);
+    auto const size = vec.size();
+    auto const chunks = (size + chunk_members - 1) / chunk_members;
+
+    std::vector<std::optional<T>> partials(chunks);
+    run_chunked(chunks, threads, [&] (size_t chunk) {
+      auto const first = chunk * chunk_members;
+      auto& partial = partials[chunk];
+      vec.visit_range(first, std::min(first + chunk_members, size), [&] (auto& val) {
+        if (partial) partial = reduce(std::move(*partial), transform(val));
+        else partial.emplace(transform(val));
+      });
+    });
+
+    for (auto& partial : partials) {
+      init = reduce(std::move(init), std::move(*partial));
+    }
+    return init;
+  }
+
+}